@@ -0,0 +1,334 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Benchmark of xatlas itself (without the Python bindings) on procedurally generated meshes.
+// Every configuration is written as one JSON object per line to stdout or to the output file.
+//
+// Usage: xatlas-benchmark [--triangles 1000,10000,...] [--meshes 1,4] [--shapes torus,plane]
+//                         [--resolutions 0,1024] [--brute-force 0,1] [--block-align 0,1]
+//                         [--repeat N] [--output results.jsonl]
+
+#include <xatlas.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Mesh
+{
+    std::vector<float>         positions; // 3 per vertex
+    std::vector<std::uint32_t> indices;   // 3 per triangle
+};
+
+// Deterministic bumps, so that the segmentation has some work to do
+float displacement(float u, float v)
+{
+    return 0.05f * std::sin(13.f * u) * std::cos(7.f * v) + 0.02f * std::sin(31.f * u + 17.f * v);
+}
+
+// Regular grid of `columns` x `rows` quads, each split into two triangles.
+// With `wrapU`/`wrapV` the grid is closed in that direction.
+Mesh makeGrid(std::uint32_t columns, std::uint32_t rows, bool wrapU, bool wrapV, void (*position)(float u, float v, float* out))
+{
+    std::uint32_t const vertexColumns = wrapU ? columns : columns + 1;
+    std::uint32_t const vertexRows    = wrapV ? rows : rows + 1;
+
+    Mesh mesh;
+    mesh.positions.resize(3 * static_cast<size_t>(vertexColumns) * vertexRows);
+    for (std::uint32_t y = 0; y < vertexRows; ++y)
+    {
+        for (std::uint32_t x = 0; x < vertexColumns; ++x)
+        {
+            float const u = static_cast<float>(x) / static_cast<float>(columns);
+            float const v = static_cast<float>(y) / static_cast<float>(rows);
+            position(u, v, &mesh.positions[3 * (static_cast<size_t>(y) * vertexColumns + x)]);
+        }
+    }
+
+    mesh.indices.reserve(6 * static_cast<size_t>(columns) * rows);
+    auto const index = [&](std::uint32_t x, std::uint32_t y) {
+        return (y % vertexRows) * vertexColumns + (x % vertexColumns);
+    };
+    for (std::uint32_t y = 0; y < rows; ++y)
+    {
+        for (std::uint32_t x = 0; x < columns; ++x)
+        {
+            std::uint32_t const i00 = index(x, y);
+            std::uint32_t const i10 = index(x + 1, y);
+            std::uint32_t const i01 = index(x, y + 1);
+            std::uint32_t const i11 = index(x + 1, y + 1);
+            mesh.indices.insert(mesh.indices.end(), {i00, i10, i11, i00, i11, i01});
+        }
+    }
+
+    return mesh;
+}
+
+void planePosition(float u, float v, float* out)
+{
+    out[0] = u;
+    out[1] = v;
+    out[2] = displacement(u, v);
+}
+
+void torusPosition(float u, float v, float* out)
+{
+    float const pi     = 3.14159265358979f;
+    float const phi    = 2.f * pi * u;
+    float const theta  = 2.f * pi * v;
+    float const radius = 0.3f + displacement(u, v);
+
+    out[0] = (1.f + radius * std::cos(theta)) * std::cos(phi);
+    out[1] = (1.f + radius * std::cos(theta)) * std::sin(phi);
+    out[2] = radius * std::sin(theta);
+}
+
+// Generates a mesh with approximately `triangleCount` triangles
+Mesh makeMesh(std::string const& shape, size_t triangleCount)
+{
+    // Quads are twice as wide as high for the torus, which has a larger major circumference
+    bool const          torus   = shape == "torus";
+    double const        quads   = std::max(1.0, static_cast<double>(triangleCount) / 2.0);
+    std::uint32_t const rows    = std::max<std::uint32_t>(3, static_cast<std::uint32_t>(std::sqrt(quads / (torus ? 2.0 : 1.0))));
+    std::uint32_t const columns = std::max<std::uint32_t>(3, static_cast<std::uint32_t>(quads / rows));
+
+    if (torus)
+    {
+        return makeGrid(columns, rows, true, true, &torusPosition);
+    }
+    if (shape == "plane")
+    {
+        return makeGrid(columns, rows, false, false, &planePosition);
+    }
+
+    throw std::invalid_argument("Unknown shape " + shape + " (expected torus or plane)");
+}
+
+template<typename T>
+std::vector<T> parseList(std::string const& text)
+{
+    std::vector<T>     values;
+    std::istringstream stream(text);
+    std::string        item;
+    while (std::getline(stream, item, ','))
+    {
+        std::istringstream itemStream(item);
+        T                  value;
+        if (!(itemStream >> value))
+        {
+            throw std::invalid_argument("Invalid list " + text);
+        }
+        values.push_back(value);
+    }
+    return values;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Configuration
+{
+    std::string   shape;
+    size_t        triangleCount;
+    std::uint32_t meshCount;
+    std::uint32_t resolution;
+    bool          bruteForce;
+    bool          blockAlign;
+};
+
+void run(Configuration const& configuration, Mesh const& mesh, std::uint32_t repeat, std::ostream& output)
+{
+    for (std::uint32_t r = 0; r < repeat; ++r)
+    {
+        xatlas::Atlas* atlas = xatlas::Create();
+
+        auto const start = Clock::now();
+
+        xatlas::MeshDecl meshDecl;
+        meshDecl.vertexCount          = static_cast<std::uint32_t>(mesh.positions.size() / 3);
+        meshDecl.vertexPositionData   = mesh.positions.data();
+        meshDecl.vertexPositionStride = sizeof(float) * 3;
+        meshDecl.indexCount           = static_cast<std::uint32_t>(mesh.indices.size());
+        meshDecl.indexData            = mesh.indices.data();
+        meshDecl.indexFormat          = xatlas::IndexFormat::UInt32;
+
+        for (std::uint32_t m = 0; m < configuration.meshCount; ++m)
+        {
+            xatlas::AddMeshError const error = xatlas::AddMesh(atlas, meshDecl, configuration.meshCount);
+            if (error != xatlas::AddMeshError::Success)
+            {
+                xatlas::Destroy(atlas);
+                throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
+            }
+        }
+        xatlas::AddMeshJoin(atlas);
+        double const addMeshSeconds = secondsSince(start);
+
+        auto const computeStart = Clock::now();
+        xatlas::ComputeCharts(atlas);
+        double const computeChartsSeconds = secondsSince(computeStart);
+
+        xatlas::PackOptions packOptions;
+        packOptions.resolution = configuration.resolution;
+        packOptions.bruteForce = configuration.bruteForce;
+        packOptions.blockAlign = configuration.blockAlign;
+
+        auto const packStart = Clock::now();
+        xatlas::PackCharts(atlas, packOptions);
+        double const packChartsSeconds = secondsSince(packStart);
+        double const totalSeconds      = secondsSince(start);
+
+        float utilization = 0.f;
+        for (std::uint32_t i = 0; i < atlas->atlasCount; ++i)
+        {
+            utilization += atlas->utilization[i];
+        }
+        utilization /= static_cast<float>(std::max<std::uint32_t>(1, atlas->atlasCount));
+
+        size_t const triangleCount = configuration.meshCount * mesh.indices.size() / 3;
+
+        output << "{\"shape\": \"" << configuration.shape << "\""
+               << ", \"triangles\": " << triangleCount
+               << ", \"meshes\": " << configuration.meshCount
+               << ", \"resolution\": " << configuration.resolution
+               << ", \"brute_force\": " << (configuration.bruteForce ? "true" : "false")
+               << ", \"block_align\": " << (configuration.blockAlign ? "true" : "false")
+               << ", \"repetition\": " << r
+               << ", \"add_mesh_seconds\": " << addMeshSeconds
+               << ", \"compute_charts_seconds\": " << computeChartsSeconds
+               << ", \"pack_charts_seconds\": " << packChartsSeconds
+               << ", \"total_seconds\": " << totalSeconds
+               << ", \"triangles_per_second\": " << static_cast<double>(triangleCount) / totalSeconds
+               << ", \"charts\": " << atlas->chartCount
+               << ", \"atlases\": " << atlas->atlasCount
+               << ", \"width\": " << atlas->width
+               << ", \"height\": " << atlas->height
+               << ", \"utilization\": " << utilization
+               << "}" << std::endl;
+
+        xatlas::Destroy(atlas);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string>   shapes      = {"torus"};
+    std::vector<size_t>        triangles   = {1000, 10000, 100000};
+    std::vector<std::uint32_t> meshCounts  = {1};
+    std::vector<std::uint32_t> resolutions = {0};
+    std::vector<int>           bruteForce  = {0};
+    std::vector<int>           blockAlign  = {0};
+    std::uint32_t              repeat      = 1;
+    std::string                outputPath;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string const argument = argv[i];
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + argument);
+            }
+
+            std::string const value = argv[++i];
+            if (argument == "--shapes")
+                shapes = parseList<std::string>(value);
+            else if (argument == "--triangles")
+                triangles = parseList<size_t>(value);
+            else if (argument == "--meshes")
+                meshCounts = parseList<std::uint32_t>(value);
+            else if (argument == "--resolutions")
+                resolutions = parseList<std::uint32_t>(value);
+            else if (argument == "--brute-force")
+                bruteForce = parseList<int>(value);
+            else if (argument == "--block-align")
+                blockAlign = parseList<int>(value);
+            else if (argument == "--repeat")
+                repeat = parseList<std::uint32_t>(value).at(0);
+            else if (argument == "--output")
+                outputPath = value;
+            else
+                throw std::invalid_argument("Unknown argument " + argument);
+        }
+
+        std::ofstream file;
+        if (!outputPath.empty())
+        {
+            file.open(outputPath);
+            if (!file.is_open())
+            {
+                throw std::invalid_argument("Cannot open path " + outputPath);
+            }
+        }
+        std::ostream& output = outputPath.empty() ? std::cout : file;
+
+        for (auto const& shape : shapes)
+        {
+            for (size_t triangleCount : triangles)
+            {
+                // Multi-mesh atlases split the triangles evenly between the meshes
+                for (std::uint32_t meshCount : meshCounts)
+                {
+                    Mesh const mesh = makeMesh(shape, triangleCount / std::max<std::uint32_t>(1, meshCount));
+                    for (std::uint32_t resolution : resolutions)
+                    {
+                        for (int bruteForce_ : bruteForce)
+                        {
+                            for (int blockAlign_ : blockAlign)
+                            {
+                                run({shape, triangleCount, meshCount, resolution, bruteForce_ != 0, blockAlign_ != 0}, mesh, repeat, output);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
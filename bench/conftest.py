@@ -0,0 +1,44 @@
+import numpy as np
+import pytest
+
+
+def pytest_addoption(parser):
+    parser.addoption("--large", action="store_true", default=False, help="Include meshes with 1M and 10M triangles")
+
+
+def pytest_generate_tests(metafunc):
+    if "triangle_count" in metafunc.fixturenames:
+        counts = [1_000, 10_000, 100_000]
+        if metafunc.config.getoption("large"):
+            counts += [1_000_000, 10_000_000]
+        metafunc.parametrize("triangle_count", counts, ids=[f"{count}tris" for count in counts], scope="module")
+
+
+def make_torus(triangle_count, seed=0):
+    """Generates a bumpy torus with approximately `triangle_count` triangles (positions float32 Nx3, faces uint32 Fx3)"""
+    quads = max(1, triangle_count // 2)
+    rows = max(3, int(np.sqrt(quads / 2)))
+    columns = max(3, quads // rows)
+
+    u, v = np.meshgrid(np.arange(columns) / columns, np.arange(rows) / rows)
+    rng = np.random.default_rng(seed)
+    radius = 0.3 + 0.05 * np.sin(13 * u) * np.cos(7 * v) + 0.002 * rng.standard_normal(u.shape)
+    phi = 2 * np.pi * u
+    theta = 2 * np.pi * v
+    positions = np.stack(
+        [(1 + radius * np.cos(theta)) * np.cos(phi), (1 + radius * np.cos(theta)) * np.sin(phi), radius * np.sin(theta)], axis=-1
+    )
+
+    x, y = np.meshgrid(np.arange(columns), np.arange(rows))
+    i00 = y * columns + x
+    i10 = y * columns + (x + 1) % columns
+    i01 = ((y + 1) % rows) * columns + x
+    i11 = ((y + 1) % rows) * columns + (x + 1) % columns
+    faces = np.concatenate([np.stack([i00, i10, i11], axis=-1).reshape(-1, 3), np.stack([i00, i11, i01], axis=-1).reshape(-1, 3)])
+
+    return positions.reshape(-1, 3).astype(np.float32), faces.astype(np.uint32)
+
+
+@pytest.fixture(scope="module")
+def torus(triangle_count):
+    return make_torus(triangle_count)
@@ -0,0 +1,86 @@
+# Benchmarks of the Python bindings.
+#
+# Run with `pytest bench --benchmark-json=results.json` (add `--large` for meshes with up to 10M triangles).
+# The packing options of each run are stored in `extra_info` of the JSON results.
+
+import pytest
+import xatlas
+from conftest import make_torus
+
+
+def pack_options(brute_force=False, block_align=False, resolution=0):
+    options = xatlas.PackOptions()
+    options.bruteForce = brute_force
+    options.blockAlign = block_align
+    options.resolution = resolution
+    return options
+
+
+def test_parametrize(benchmark, torus):
+    positions, faces = torus
+    benchmark.extra_info["triangles"] = len(faces)
+    benchmark.pedantic(xatlas.parametrize, args=(positions, faces), rounds=3)
+
+
+@pytest.mark.parametrize(
+    "brute_force,block_align,resolution",
+    [(False, False, 0), (True, False, 0), (False, True, 0), (False, False, 1024), (False, False, 4096)],
+    ids=["default", "brute_force", "block_align", "resolution_1024", "resolution_4096"],
+)
+def test_generate(benchmark, torus, brute_force, block_align, resolution):
+    positions, faces = torus
+    options = pack_options(brute_force, block_align, resolution)
+
+    def setup():
+        atlas = xatlas.Atlas()
+        atlas.add_mesh(positions, faces)
+        return (atlas,), {}
+
+    def generate(atlas):
+        atlas.generate(pack_options=options)
+        return atlas
+
+    atlas = benchmark.pedantic(generate, setup=setup, rounds=3)
+    benchmark.extra_info.update(
+        triangles=len(faces),
+        brute_force=brute_force,
+        block_align=block_align,
+        resolution=resolution,
+        charts=atlas.chart_count,
+        utilization=atlas.utilization,
+        width=atlas.width,
+        height=atlas.height,
+    )
+
+
+@pytest.mark.parametrize("mesh_count", [4, 16])
+def test_generate_multi_mesh(benchmark, mesh_count):
+    meshes = [make_torus(10_000, seed) for seed in range(mesh_count)]
+
+    def generate():
+        atlas = xatlas.Atlas()
+        for positions, faces in meshes:
+            atlas.add_mesh(positions, faces)
+        atlas.generate()
+        return atlas
+
+    atlas = benchmark.pedantic(generate, rounds=3)
+    benchmark.extra_info.update(meshes=mesh_count, triangles=sum(len(faces) for _, faces in meshes), charts=atlas.chart_count)
+
+
+def test_get_mesh(benchmark, torus):
+    positions, faces = torus
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(positions, faces)
+    atlas.generate()
+
+    benchmark.extra_info["triangles"] = len(faces)
+    benchmark(atlas.get_mesh, 0)
+
+
+def test_export(benchmark, torus, tmp_path):
+    positions, faces = torus
+    vmapping, indices, uvs = xatlas.parametrize(positions, faces)
+
+    benchmark.extra_info["triangles"] = len(faces)
+    benchmark.pedantic(xatlas.export, args=(str(tmp_path / "output.obj"), positions[vmapping], indices, uvs), rounds=3)
@@ -0,0 +1,82 @@
+# Copies xatlas.h and xatlas.cpp from XATLAS_SOURCE_DIR to XATLAS_OUTPUT_DIR and patches the copies, so that
+# xatlas::Create takes the number of threads of its task scheduler, xatlas::SetThreadCount limits the threads
+# that run the tasks of an atlas and xatlas::SetThreadContext passes a value from the thread that creates an atlas
+# to the worker threads of its scheduler. The sources of the submodule are left untouched.
+#
+# Usage: cmake -DXATLAS_SOURCE_DIR=<dir> -DXATLAS_OUTPUT_DIR=<dir> -P xatlas-thread-count.cmake
+
+if (NOT XATLAS_SOURCE_DIR OR NOT XATLAS_OUTPUT_DIR)
+    message(FATAL_ERROR "XATLAS_SOURCE_DIR and XATLAS_OUTPUT_DIR must be set.")
+endif()
+
+# Replaces the only match of `regex` in the variable `content`, failing if there is none or more than one,
+# so that a changed upstream source stops the build instead of being patched in the wrong place
+function(patch_once content regex replacement)
+    string(REGEX MATCH "${regex}" match "${${content}}")
+    if (match STREQUAL "")
+        message(FATAL_ERROR "xatlas-thread-count: no match for '${regex}'.")
+    endif()
+
+    string(FIND "${${content}}" "${match}" position)
+    string(LENGTH "${match}" length)
+    math(EXPR end "${position} + ${length}")
+    string(SUBSTRING "${${content}}" ${end} -1 rest)
+    string(REGEX MATCH "${regex}" second "${rest}")
+    if (NOT second STREQUAL "")
+        message(FATAL_ERROR "xatlas-thread-count: more than one match for '${regex}'.")
+    endif()
+
+    string(REGEX REPLACE "${regex}" "${replacement}" patched "${${content}}")
+    set(${content} "${patched}" PARENT_SCOPE)
+endfunction()
+
+file(READ ${XATLAS_SOURCE_DIR}/xatlas.h header)
+
+patch_once(header "Atlas \\*Create\\(\\);"
+    "// With XA_MULTITHREADED, its tasks run on threadCount threads including the calling thread. 0 uses all hardware threads.\nAtlas *Create(uint32_t threadCount = 0);\n\n// Limit the number of threads (including the calling thread) that run the tasks of the atlas. 0 removes the limit.\nvoid SetThreadCount(Atlas *atlas, uint32_t threadCount);\n\n// The value returned by capture on the thread that creates an atlas is passed to apply on each worker thread of the atlas\n// when the thread starts (e.g. to attribute the allocations of the workers to the atlas).\ntypedef void *(*CaptureThreadContextFunc)();\ntypedef void (*ApplyThreadContextFunc)(void *context);\nvoid SetThreadContext(CaptureThreadContextFunc capture, ApplyThreadContextFunc apply);")
+
+file(READ ${XATLAS_SOURCE_DIR}/xatlas.cpp source)
+
+# The scheduler starts threadCount - 1 workers. The calling thread runs the tasks of a group while waiting for it,
+# so a single thread needs no worker.
+patch_once(source "class TaskScheduler([ \t\r\n]*{[ \t\r\n]*public:[ \t\r\n]*)TaskScheduler\\(\\) : m_shutdown\\(false\\)"
+    "static CaptureThreadContextFunc s_captureThreadContext = nullptr;\nstatic ApplyThreadContextFunc s_applyThreadContext = nullptr;\n\nclass TaskScheduler\\1TaskScheduler(uint32_t threadCount = 0) : m_shutdown(false)")
+patch_once(source "m_maxGroups = std::thread::hardware_concurrency\\(\\) \\* 4;"
+    "m_threadContext = s_captureThreadContext ? s_captureThreadContext() : nullptr;\n\t\tm_threadCount = threadCount > 0 ? threadCount : max(1u, std::thread::hardware_concurrency());\n\t\tm_activeWorkers = m_threadCount - 1;\n\t\tm_maxGroups = m_threadCount * 4;")
+patch_once(source "m_workers\\.resize\\([^;]*\\);"
+    "m_workers.resize(m_threadCount - 1);")
+patch_once(source "uint32_t threadCount\\(\\) const[^}]*hardware_concurrency[^}]*}"
+    "uint32_t threadCount() const\n\t{\n\t\treturn m_threadCount; // Including the main thread.\n\t}\n\n\t// Tasks only wake up the first threadCount - 1 workers.\n\tvoid setActiveThreadCount(uint32_t threadCount)\n\t{\n\t\tm_activeWorkers = threadCount > 0 ? min(threadCount, m_threadCount) - 1 : m_threadCount - 1;\n\t}")
+
+# Only the loop of run() wakes the workers with `m_workers[i].wakeup`, the destructor must still wake all of them
+patch_once(source "for \\(uint32_t i = 0; i < m_workers\\.size\\(\\); i\\+\\+\\)( {[ \t\r\n]*m_workers\\[i\\]\\.wakeup = true;)"
+    "for (uint32_t i = 0; i < m_activeWorkers; i++)\\1")
+patch_once(source "uint32_t m_maxGroups;"
+    "uint32_t m_maxGroups;\n\tuint32_t m_threadCount;\n\tstd::atomic<uint32_t> m_activeWorkers;\n\tvoid *m_threadContext;")
+
+# The workers apply the context captured by the constructor before they wait for tasks
+patch_once(source "(static void workerThread\\(TaskScheduler \\*([A-Za-z_]+),[^)]*\\)[ \t\r\n]*{)"
+    "\\1\n\t\tif (s_applyThreadContext)\n\t\t\ts_applyThreadContext(\\2->m_threadContext);")
+
+patch_once(source "Atlas \\*Create\\(\\)"
+    "void SetThreadCount(Atlas *atlas, uint32_t threadCount)\n{\n\tXA_DEBUG_ASSERT(atlas);\n#if XA_MULTITHREADED\n\tContext *ctx = (Context *)atlas;\n\tctx->taskScheduler->setActiveThreadCount(threadCount);\n#else\n\t(void)atlas;\n\t(void)threadCount;\n#endif\n}\n\nvoid SetThreadContext(CaptureThreadContextFunc capture, ApplyThreadContextFunc apply)\n{\n#if XA_MULTITHREADED\n\tinternal::s_captureThreadContext = capture;\n\tinternal::s_applyThreadContext = apply;\n#else\n\t(void)capture;\n\t(void)apply;\n#endif\n}\n\nAtlas *Create(uint32_t threadCount)")
+patch_once(source "[ \t]*ctx->taskScheduler = XA_NEW\\(internal::MemTag::Default, internal::TaskScheduler\\);"
+    "#if XA_MULTITHREADED\n\tctx->taskScheduler = XA_NEW_ARGS(internal::MemTag::Default, internal::TaskScheduler, threadCount);\n#else\n\t(void)threadCount;\n\tctx->taskScheduler = XA_NEW(internal::MemTag::Default, internal::TaskScheduler);\n#endif")
+
+# Only rewrite changed outputs, so that the library is not rebuilt on every configure
+foreach (name IN ITEMS xatlas.h xatlas.cpp)
+    if (name STREQUAL "xatlas.h")
+        set(content "${header}")
+    else()
+        set(content "${source}")
+    endif()
+
+    set(path ${XATLAS_OUTPUT_DIR}/${name})
+    set(previous "")
+    if (EXISTS ${path})
+        file(READ ${path} previous)
+    endif()
+    if (NOT previous STREQUAL content)
+        file(WRITE ${path} "${content}")
+    endif()
+endforeach()
@@ -0,0 +1,196 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "async.hpp"
+#include "threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace py = pybind11;
+
+namespace
+{
+
+std::mutex               g_mutex;
+std::condition_variable  g_finished;
+std::size_t              g_pending = 0;
+std::atomic<std::size_t> g_running(0); // Jobs whose work is running
+
+// Intentionally leaked, it must outlive the interpreter's module objects
+py::handle g_futureType;
+
+struct Job
+{
+    std::function<void()>       work;
+    std::function<py::object()> finish;
+    py::object                  future;
+};
+
+// Converts a C++ exception into a Python exception object using the registered translators
+py::object toPythonException(std::exception_ptr exception)
+{
+    py::cpp_function rethrow([exception]() { std::rethrow_exception(exception); });
+    try
+    {
+        rethrow();
+    }
+    catch (py::error_already_set& error)
+    {
+        return error.value();
+    }
+
+    // Not reached, the call always raises
+    return py::none();
+}
+
+void run(std::shared_ptr<Job> job)
+{
+    std::exception_ptr exception;
+    ++g_running;
+    try
+    {
+        job->work();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+    --g_running;
+
+    {
+        py::gil_scoped_acquire acquire;
+
+        // `finish` also runs after a failure, e.g. to release resources, but the first exception wins
+        py::object result;
+        try
+        {
+            result = job->finish();
+        }
+        catch (...)
+        {
+            if (!exception)
+            {
+                exception = std::current_exception();
+            }
+        }
+
+        try
+        {
+            if (exception)
+            {
+                job->future.attr("set_exception")(toPythonException(exception));
+            }
+            else
+            {
+                job->future.attr("set_result")(result);
+            }
+        }
+        catch (py::error_already_set& error)
+        {
+            // Nobody could handle it, e.g. an exception in a done callback of the future
+            error.discard_as_unraisable("xatlas.Future");
+        }
+
+        job.reset();
+    }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    --g_pending;
+    g_finished.notify_all();
+}
+
+} // namespace
+
+py::object AsyncJob::submit(std::function<void()> work, std::function<py::object()> finish)
+{
+    auto job    = std::make_unique<Job>();
+    job->work   = std::move(work);
+    job->finish = std::move(finish);
+    job->future = g_futureType();
+    job->future.attr("set_running_or_notify_cancel")();
+
+    py::object future = job->future;
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        ++g_pending;
+    }
+
+    try
+    {
+        // The pool runs std::function, which must be copyable
+        std::shared_ptr<Job> shared(std::move(job));
+        submitTask([shared]() mutable { run(std::move(shared)); });
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        --g_pending;
+        throw;
+    }
+
+    return future;
+}
+
+unsigned int AsyncJob::threadShare()
+{
+    std::size_t const running = std::max<std::size_t>(1, g_running);
+    return static_cast<unsigned int>(std::max<std::size_t>(1, defaultThreadCount() / running));
+}
+
+void AsyncJob::waitAll()
+{
+    py::gil_scoped_release release;
+
+    std::unique_lock<std::mutex> lock(g_mutex);
+    g_finished.wait(lock, []() { return g_pending == 0; });
+}
+
+void AsyncJob::bind(py::module& m)
+{
+    // Subclass of concurrent.futures.Future that is awaitable through asyncio.wrap_future
+    py::cpp_function awaitFunction([](py::object self) {
+        return py::module::import("asyncio").attr("wrap_future")(self).attr("__await__")();
+    });
+
+    py::dict attributes;
+    attributes["__module__"] = m.attr("__name__");
+    attributes["__doc__"]    = "A concurrent.futures.Future of a native background operation, which can also be awaited.";
+    attributes["__await__"]  = py::reinterpret_steal<py::object>(PyInstanceMethod_New(awaitFunction.ptr()));
+
+    py::object base  = py::module::import("concurrent.futures").attr("Future");
+    py::object type  = py::module::import("builtins").attr("type")("Future", py::make_tuple(base), attributes);
+    g_futureType     = type.inc_ref();
+    m.attr("Future") = type;
+
+    // Jobs hold references to Python objects and need the interpreter to finish
+    py::module::import("atexit").attr("register")(py::cpp_function(&AsyncJob::waitAll));
+}
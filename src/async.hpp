@@ -0,0 +1,48 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <pybind11/pybind11.h>
+
+#include <functional>
+
+// Runs native work on background threads and reports the results through `xatlas.Future`,
+// a `concurrent.futures.Future` that can also be awaited in asyncio.
+class AsyncJob
+{
+public:
+    // Runs `work` on the shared thread pool without the GIL, then `finish` with the GIL (also if `work` threw), and
+    // resolves the returned future with the result of `finish` or the first exception raised by either of them.
+    // Python objects captured by the functions are released with the GIL held.
+    static pybind11::object submit(std::function<void()> work, std::function<pybind11::object()> finish);
+
+    // Threads for the work of one job: the default thread count shared by the running jobs (at least 1)
+    static unsigned int threadShare();
+
+    // Blocks until all submitted jobs are finished (releases the GIL while waiting)
+    static void waitAll();
+
+    static void bind(pybind11::module& m);
+};
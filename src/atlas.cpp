@@ -23,154 +23,1062 @@
  */
 
 #include "atlas.hpp"
+#include "async.hpp"
+#include "bake.hpp"
+#include "loader.hpp"
+#include "serialization.hpp"
+#include "threading.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <map>
 #include <random>
+#include <string>
+#include <vector>
 
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
 namespace py = pybind11;
 
-Atlas::Atlas()
+namespace
 {
-    m_atlas = xatlas::Create();
+
+// Inputs are hashed by value, so the same mesh has the same hash regardless of its dtypes and layout
+
+void hashVertices(Hasher& hasher, void const* data, std::uint32_t stride, std::uint32_t count, std::uint32_t components)
+{
+    std::size_t const size = sizeof(float) * components;
+
+    hasher.update(count);
+    if (stride == size)
+    {
+        hasher.update(data, size * count);
+        return;
+    }
+
+    auto const* bytes = static_cast<char const*>(data);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        hasher.update(bytes + static_cast<std::size_t>(stride) * i, size);
+    }
 }
 
-Atlas::~Atlas()
+void hashIndices(Hasher& hasher, void const* data, xatlas::IndexFormat format, std::uint32_t count)
 {
-    xatlas::Destroy(m_atlas);
+    hasher.update(count);
+    if (format == xatlas::IndexFormat::UInt32)
+    {
+        hasher.update(data, sizeof(std::uint32_t) * count);
+        return;
+    }
+
+    // Widen uint16 indices in small blocks
+    auto const*                    indices = static_cast<std::uint16_t const*>(data);
+    std::array<std::uint32_t, 256> block;
+    for (std::uint32_t begin = 0; begin < count; begin += static_cast<std::uint32_t>(block.size()))
+    {
+        std::uint32_t const end = std::min(count, begin + static_cast<std::uint32_t>(block.size()));
+        std::copy(indices + begin, indices + end, block.begin());
+        hasher.update(block.data(), sizeof(std::uint32_t) * (end - begin));
+    }
 }
 
-void Atlas::addMesh(ContiguousArray<float> const&         positions,
-                    ContiguousArray<std::uint32_t> const& indices,
-                    std::optional<ContiguousArray<float>> normals,
-                    std::optional<ContiguousArray<float>> uvs)
+void hashMeshDecl(Hasher& hasher, xatlas::MeshDecl const& meshDecl)
 {
-    // Perform sanity checks on the inputs
-    checkShape("Position", positions, 3);
-    checkShape("Index", indices, 3);
-    if (normals)
+    hasher.update(std::uint32_t(0)); // Mesh
+    hashVertices(hasher, meshDecl.vertexPositionData, meshDecl.vertexPositionStride, meshDecl.vertexCount, 3);
+    hashIndices(hasher, meshDecl.indexData, meshDecl.indexFormat, meshDecl.indexCount);
+
+    hasher.update(meshDecl.vertexNormalData != nullptr);
+    if (meshDecl.vertexNormalData)
     {
-        checkShape("Normal", *normals, 3, positions.shape(0));
+        hashVertices(hasher, meshDecl.vertexNormalData, meshDecl.vertexNormalStride, meshDecl.vertexCount, 3);
     }
-    if (uvs)
+
+    hasher.update(meshDecl.vertexUvData != nullptr);
+    if (meshDecl.vertexUvData)
     {
-        checkShape("Texture coordinate", *uvs, 2, positions.shape(0));
+        hashVertices(hasher, meshDecl.vertexUvData, meshDecl.vertexUvStride, meshDecl.vertexCount, 2);
     }
+}
 
-    // Fill the mesh declaration
+void hashUvMeshDecl(Hasher& hasher, xatlas::UvMeshDecl const& meshDecl)
+{
+    hasher.update(std::uint32_t(1)); // UV mesh
+    hashVertices(hasher, meshDecl.vertexUvData, meshDecl.vertexStride, meshDecl.vertexCount, 2);
+    hashIndices(hasher, meshDecl.indexData, meshDecl.indexFormat, meshDecl.indexCount);
+    if (meshDecl.faceMaterialData)
+    {
+        hasher.update(meshDecl.faceMaterialData, sizeof(std::uint32_t) * (meshDecl.indexCount / 3));
+    }
+}
+
+// Tiered packing depends on the time budget, so it is part of the cache key
+std::uint64_t cacheKey(Hasher inputs, xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions, std::optional<double> timeBudget)
+{
+    if (timeBudget)
+    {
+        inputs.update(std::uint32_t(2)); // Time budget
+        inputs.update(*timeBudget);
+    }
+    return Cache::key(inputs, chartOptions, packOptions);
+}
+
+void checkTimeBudget(std::optional<double> timeBudget)
+{
+    if (timeBudget && !(*timeBudget >= 0.0))
+    {
+        throw std::invalid_argument("The time budget must not be negative.");
+    }
+}
+
+// Validates the offsets of the meshes in concatenated arrays (number of meshes + 1, from 0 to `total`)
+std::vector<std::uint32_t> readOffsets(std::string const& name, py::object const& object, std::uint32_t total)
+{
+    ContiguousArray<std::int64_t> const array = ContiguousArray<std::int64_t>::ensure(object);
+    if (!array || array.ndim() != 1 || array.size() < 2)
+    {
+        throw std::invalid_argument(name + " offsets must be a 1-dimensional array with one entry per mesh plus one.");
+    }
+
+    std::int64_t const*        data = array.data();
+    std::vector<std::uint32_t> offsets(static_cast<std::size_t>(array.size()));
+    for (std::size_t i = 0; i < offsets.size(); ++i)
+    {
+        if (data[i] < (i == 0 ? 0 : data[i - 1]) || data[i] > total)
+        {
+            throw std::invalid_argument(name + " offsets must be non-decreasing and within [0, " + std::to_string(total) + "].");
+        }
+        offsets[i] = static_cast<std::uint32_t>(data[i]);
+    }
+
+    if (offsets.front() != 0 || offsets.back() != total)
+    {
+        throw std::invalid_argument(name + " offsets must start at 0 and end at " + std::to_string(total) + ".");
+    }
+
+    return offsets;
+}
+
+inline void const* offsetPointer(void const* data, std::size_t stride, std::uint32_t index)
+{
+    return data ? static_cast<char const*>(data) + stride * index : nullptr;
+}
+
+inline std::size_t indexSize(xatlas::IndexFormat format)
+{
+    return format == xatlas::IndexFormat::UInt32 ? sizeof(std::uint32_t) : sizeof(std::uint16_t);
+}
+
+// Declaration of the vertices [vertexBegin, vertexEnd) and faces [faceBegin, faceEnd) of concatenated arrays
+xatlas::MeshDecl sliceMeshDecl(xatlas::MeshDecl const& meshDecl, std::uint32_t vertexBegin, std::uint32_t vertexEnd, std::uint32_t faceBegin, std::uint32_t faceEnd)
+{
+    xatlas::MeshDecl slice = meshDecl;
+
+    slice.vertexCount        = vertexEnd - vertexBegin;
+    slice.vertexPositionData = offsetPointer(meshDecl.vertexPositionData, meshDecl.vertexPositionStride, vertexBegin);
+    slice.vertexNormalData   = offsetPointer(meshDecl.vertexNormalData, meshDecl.vertexNormalStride, vertexBegin);
+    slice.vertexUvData       = offsetPointer(meshDecl.vertexUvData, meshDecl.vertexUvStride, vertexBegin);
+
+    slice.indexCount = (faceEnd - faceBegin) * 3;
+    slice.indexData  = offsetPointer(meshDecl.indexData, indexSize(meshDecl.indexFormat) * 3, faceBegin);
+
+    return slice;
+}
+
+xatlas::UvMeshDecl sliceUvMeshDecl(xatlas::UvMeshDecl const& meshDecl, std::uint32_t vertexBegin, std::uint32_t vertexEnd, std::uint32_t faceBegin, std::uint32_t faceEnd)
+{
+    xatlas::UvMeshDecl slice = meshDecl;
+
+    slice.vertexCount  = vertexEnd - vertexBegin;
+    slice.vertexUvData = offsetPointer(meshDecl.vertexUvData, meshDecl.vertexStride, vertexBegin);
+
+    slice.indexCount       = (faceEnd - faceBegin) * 3;
+    slice.indexData        = offsetPointer(meshDecl.indexData, indexSize(meshDecl.indexFormat) * 3, faceBegin);
+    slice.faceMaterialData = static_cast<std::uint32_t const*>(offsetPointer(meshDecl.faceMaterialData, sizeof(std::uint32_t), faceBegin));
+
+    return slice;
+}
+
+} // namespace
+
+MeshInput::MeshInput(py::object const&                positions_,
+                     py::object const&                indices_,
+                     std::optional<py::object> const& normals_,
+                     std::optional<py::object> const& uvs_)
+    : positions("Position", positions_, 3)
+    , indices("Index", indices_, 3)
+{
+    if (normals_)
+    {
+        normals.emplace("Normal", *normals_, 3, positions.count());
+    }
+    if (uvs_)
+    {
+        uvs.emplace("Texture coordinate", *uvs_, 2, positions.count());
+    }
+}
+
+xatlas::MeshDecl MeshInput::meshDecl() const
+{
     xatlas::MeshDecl meshDecl;
 
-    meshDecl.vertexCount          = static_cast<std::uint32_t>(positions.shape(0));
+    meshDecl.vertexCount          = positions.count();
     meshDecl.vertexPositionData   = positions.data();
-    meshDecl.vertexPositionStride = sizeof(float) * 3; // X, Y, Z
+    meshDecl.vertexPositionStride = positions.stride();
 
-    meshDecl.indexCount  = static_cast<std::uint32_t>(indices.size());
+    meshDecl.indexCount  = indices.count();
     meshDecl.indexData   = indices.data();
-    meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
+    meshDecl.indexFormat = indices.format();
 
     if (normals)
     {
         meshDecl.vertexNormalData   = normals->data();
-        meshDecl.vertexNormalStride = sizeof(float) * 3;
+        meshDecl.vertexNormalStride = normals->stride();
     }
 
     if (uvs)
     {
         meshDecl.vertexUvData   = uvs->data();
+        meshDecl.vertexUvStride = uvs->stride();
+    }
+
+    return meshDecl;
+}
+
+void MeshInput::hash(Hasher& hasher) const
+{
+    // Hashed by declaration, so meshes loaded from files or added in batches share cache entries with arrays
+    hashMeshDecl(hasher, meshDecl());
+}
+
+bool MeshInput::copied() const
+{
+    return positions.copied() || indices.copied() || (normals && normals->copied()) || (uvs && uvs->copied());
+}
+
+Atlas::BusyScope::BusyScope(Atlas const& atlas, bool write)
+    : m_atlas(atlas)
+    , m_memory(atlas.m_memory.get())
+{
+    if (write)
+    {
+        m_atlas.checkWritable();
+    }
+    else
+    {
+        m_atlas.checkNotExported();
+    }
+
+    m_atlas.acquireBusy();
+    m_atlas.m_memory->rearm();
+    xatlas::SetThreadCount(m_atlas.m_atlas, defaultThreadCount());
+}
+
+Atlas::BusyScope::~BusyScope()
+{
+    m_atlas.m_busy = false;
+}
+
+Atlas::ReadScope::ReadScope(Atlas const& atlas)
+    : m_atlas(atlas)
+{
+    // Registered before checking the flag, so that `acquireBusy` sees the reader if the flag was not set yet
+    ++m_atlas.m_readers;
+    if (m_atlas.m_busy)
+    {
+        --m_atlas.m_readers;
+        throw std::runtime_error("The atlas is in use by another thread.");
+    }
+}
+
+Atlas::ReadScope::~ReadScope()
+{
+    --m_atlas.m_readers;
+}
+
+Atlas::Atlas(bool poolAllocator, std::optional<std::size_t> memoryBudget)
+    : m_busy(false)
+    , m_readers(0)
+    , m_imageExports(0)
+    , m_chartsComputed(false)
+    , m_lastInputCopied(false)
+    , m_readOnly(false)
+    , m_progress(std::make_unique<ProgressMonitor>())
+    , m_memory(MemoryTracker::create(poolAllocator, memoryBudget, true))
+{
+    // xatlas cannot handle failed allocations, so exceeding the budget cancels the operation at the next progress update instead
+    if (memoryBudget)
+    {
+        ProgressMonitor*  progress = m_progress.get();
+        std::size_t const budget   = *memoryBudget;
+        m_memory->setBudgetHandler([progress, budget]() {
+            progress->cancel(std::make_exception_ptr(MemoryBudgetError("The memory budget of " + std::to_string(budget) + " bytes was exceeded.")));
+        });
+    }
+
+    // The task scheduler of xatlas starts its worker threads right away
+    MemoryScope memory(m_memory.get());
+    m_atlas = xatlas::Create(defaultThreadCount());
+    m_progress->setTimeline(&m_timeline);
+    m_progress->attach(m_atlas);
+}
+
+Atlas::Atlas(std::unique_ptr<RestoredAtlas> restored)
+    : Atlas()
+{
+    m_restored = std::move(restored);
+    m_readOnly = true;
+}
+
+Atlas::~Atlas()
+{
+    // Meshes may still be processed by the xatlas worker threads, which need
+    // the GIL to report progress, so it must not be held while waiting for them
+    if (PyGILState_Check())
+    {
+        py::gil_scoped_release release;
+        xatlas::Destroy(m_atlas);
+    }
+    else
+    {
+        xatlas::Destroy(m_atlas);
+    }
+}
+
+void Atlas::addMesh(py::object const&           positions,
+                    py::object const&           indices,
+                    std::optional<py::object>   normals,
+                    std::optional<py::object>   uvs,
+                    std::optional<py::function> progressCallback,
+                    std::optional<WeldOptions>  weld)
+{
+    Timeline::Scope timing(m_timeline, "add_mesh");
+
+    // Validates the inputs and converts them only if xatlas cannot read them directly
+    MeshInput const           input(positions, indices, normals, uvs);
+    std::optional<WeldedMesh> welded;
+
+    xatlas::AddMeshError error;
+    {
+        // The input arrays are referenced by the caller for the duration of the call and
+        // xatlas copies them before returning, so they can be read without holding the GIL
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed  = false;
+        m_lastInputCopied = input.copied();
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        input.hash(m_inputHash);
+
+        xatlas::MeshDecl meshDecl = input.meshDecl();
+        if (weld)
+        {
+            weld->hash(m_inputHash);
+            welded.emplace(weldMesh(meshDecl, *weld));
+            meshDecl = welded->meshDecl();
+        }
+
+        error = xatlas::AddMesh(m_atlas, meshDecl);
+    }
+
+    // Keeps the remaps aligned with the meshes of xatlas
+    if (error == xatlas::AddMeshError::Success)
+    {
+        m_vertexRemaps.push_back(welded ? std::move(welded->remap) : std::vector<std::uint32_t>());
+    }
+
+    m_progress->throwIfCancelled();
+
+    if (error != xatlas::AddMeshError::Success)
+    {
+        throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
+    }
+}
+
+void Atlas::addMeshFromFile(std::string const& path, unsigned int numThreads, std::optional<py::function> progressCallback, std::optional<WeldOptions> weld)
+{
+    Timeline::Scope timing(m_timeline, "add_mesh_from_file");
+
+    // Parse the file without creating intermediate Python objects
+    MeshData mesh;
+    {
+        py::gil_scoped_release release;
+        mesh = readMesh(path, numThreads);
+    }
+
+    if (mesh.vertexCount() == 0 || mesh.indices.empty())
+    {
+        throw std::runtime_error("The file " + path + " does not contain a triangle mesh.");
+    }
+
+    xatlas::MeshDecl meshDecl;
+
+    meshDecl.vertexCount          = static_cast<std::uint32_t>(mesh.vertexCount());
+    meshDecl.vertexPositionData   = mesh.positions.data();
+    meshDecl.vertexPositionStride = sizeof(float) * 3;
+
+    meshDecl.indexCount  = static_cast<std::uint32_t>(mesh.indices.size());
+    meshDecl.indexData   = mesh.indices.data();
+    meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
+
+    if (!mesh.normals.empty())
+    {
+        meshDecl.vertexNormalData   = mesh.normals.data();
+        meshDecl.vertexNormalStride = sizeof(float) * 3;
+    }
+
+    if (!mesh.uvs.empty())
+    {
+        meshDecl.vertexUvData   = mesh.uvs.data();
         meshDecl.vertexUvStride = sizeof(float) * 2;
     }
 
-    xatlas::AddMeshError error = xatlas::AddMesh(m_atlas, meshDecl);
+    std::optional<WeldedMesh> welded;
+    xatlas::AddMeshError      error;
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed  = false;
+        m_lastInputCopied = false;
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        hashMeshDecl(m_inputHash, meshDecl);
+
+        if (weld)
+        {
+            weld->hash(m_inputHash);
+            welded.emplace(weldMesh(meshDecl, *weld, numThreads));
+            meshDecl = welded->meshDecl();
+        }
+
+        error = xatlas::AddMesh(m_atlas, meshDecl);
+    }
+
+    if (error == xatlas::AddMeshError::Success)
+    {
+        m_vertexRemaps.push_back(welded ? std::move(welded->remap) : std::vector<std::uint32_t>());
+    }
+
+    m_progress->throwIfCancelled();
 
-    if (error != xatlas::AddMeshError::Success) {
+    if (error != xatlas::AddMeshError::Success)
+    {
         throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
     }
 }
 
-void Atlas::addUvMesh(ContiguousArray<float> const&            uvs,
-                      ContiguousArray<std::uint32_t> const&    indices,
-                      std::optional<ContiguousArray<uint32_t>> faceMaterials)
+void Atlas::addUvMesh(py::object const&                        uvs,
+                      py::object const&                        indices,
+                      std::optional<ContiguousArray<uint32_t>> faceMaterials,
+                      std::optional<py::function>              progressCallback)
 {
+    Timeline::Scope timing(m_timeline, "add_uv_mesh");
+
     // Perform sanity checks on the inputs
-    checkShape("Texture coordinate", uvs, 2);
-    checkShape("Index", indices, 3);
+    VertexBuffer const uvs_("Texture coordinate", uvs, 2);
+    IndexBuffer const  indices_("Index", indices, 3);
     if (faceMaterials)
     {
-        checkShape("Face material ID", *faceMaterials, 1, indices.shape(0));
+        checkShape("Face material ID", *faceMaterials, 1, indices_.rows());
     }
 
     // Fill the mesh declaration
     xatlas::UvMeshDecl meshDecl;
 
-    meshDecl.vertexCount  = static_cast<std::uint32_t>(uvs.shape(0));
-    meshDecl.vertexUvData = uvs.data();
-    meshDecl.vertexStride = sizeof(float) * 2; // U, V
+    meshDecl.vertexCount  = uvs_.count();
+    meshDecl.vertexUvData = uvs_.data();
+    meshDecl.vertexStride = uvs_.stride();
+
+    meshDecl.indexCount  = indices_.count();
+    meshDecl.indexData   = indices_.data();
+    meshDecl.indexFormat = indices_.format();
+
+    if (faceMaterials)
+    {
+        meshDecl.faceMaterialData = faceMaterials->data();
+    }
+
+    xatlas::AddMeshError error;
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed  = false;
+        m_lastInputCopied = uvs_.copied() || indices_.copied();
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        hashUvMeshDecl(m_inputHash, meshDecl);
+        error = xatlas::AddUvMesh(m_atlas, meshDecl);
+    }
+
+    if (error == xatlas::AddMeshError::Success)
+    {
+        m_vertexRemaps.emplace_back();
+    }
+
+    m_progress->throwIfCancelled();
+
+    if (error != xatlas::AddMeshError::Success)
+    {
+        throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
+    }
+}
+
+void Atlas::addMeshes(py::object const&           positions,
+                      py::object const&           indices,
+                      py::object const&           vertexOffsets,
+                      py::object const&           faceOffsets,
+                      std::optional<py::object>   normals,
+                      std::optional<py::object>   uvs,
+                      std::optional<py::function> progressCallback,
+                      std::optional<WeldOptions>  weld)
+{
+    Timeline::Scope timing(m_timeline, "add_meshes");
+
+    // The concatenated arrays are validated once for all meshes
+    MeshInput const                  input(positions, indices, normals, uvs);
+    std::vector<std::uint32_t> const vertices = readOffsets("Vertex", vertexOffsets, input.positions.count());
+    std::vector<std::uint32_t> const faces    = readOffsets("Face", faceOffsets, input.indices.rows());
+    if (vertices.size() != faces.size())
+    {
+        throw std::invalid_argument("Vertex and face offsets must have the same length.");
+    }
+
+    std::uint32_t const  meshCount = static_cast<std::uint32_t>(vertices.size() - 1);
+    std::uint32_t        added     = 0;
+    xatlas::AddMeshError error     = xatlas::AddMeshError::Success;
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed  = false;
+        m_lastInputCopied = input.copied();
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+
+        xatlas::MeshDecl const meshDecls = input.meshDecl();
+        for (; added < meshCount && !m_progress->cancelled(); ++added)
+        {
+            xatlas::MeshDecl meshDecl = sliceMeshDecl(meshDecls, vertices[added], vertices[added + 1], faces[added], faces[added + 1]);
+            hashMeshDecl(m_inputHash, meshDecl);
+
+            std::optional<WeldedMesh> welded;
+            if (weld)
+            {
+                weld->hash(m_inputHash);
+                welded.emplace(weldMesh(meshDecl, *weld));
+                meshDecl = welded->meshDecl();
+            }
+
+            error = xatlas::AddMesh(m_atlas, meshDecl, meshCount);
+            if (error != xatlas::AddMeshError::Success)
+            {
+                break;
+            }
+
+            m_vertexRemaps.push_back(welded ? std::move(welded->remap) : std::vector<std::uint32_t>());
+        }
+    }
+
+    m_progress->throwIfCancelled();
+
+    // The meshes before the failed one remain added, as with separate calls
+    if (error != xatlas::AddMeshError::Success)
+    {
+        throw std::runtime_error("Adding mesh " + std::to_string(added) + " failed: " + std::string(xatlas::StringForEnum(error)));
+    }
+}
+
+void Atlas::addUvMeshes(py::object const&                        uvs,
+                        py::object const&                        indices,
+                        py::object const&                        vertexOffsets,
+                        py::object const&                        faceOffsets,
+                        std::optional<ContiguousArray<uint32_t>> faceMaterials,
+                        std::optional<py::function>              progressCallback)
+{
+    Timeline::Scope timing(m_timeline, "add_uv_meshes");
+
+    VertexBuffer const uvs_("Texture coordinate", uvs, 2);
+    IndexBuffer const  indices_("Index", indices, 3);
+    if (faceMaterials)
+    {
+        checkShape("Face material ID", *faceMaterials, 1, indices_.rows());
+    }
+
+    std::vector<std::uint32_t> const vertices = readOffsets("Vertex", vertexOffsets, uvs_.count());
+    std::vector<std::uint32_t> const faces    = readOffsets("Face", faceOffsets, indices_.rows());
+    if (vertices.size() != faces.size())
+    {
+        throw std::invalid_argument("Vertex and face offsets must have the same length.");
+    }
+
+    xatlas::UvMeshDecl meshDecls;
+
+    meshDecls.vertexCount  = uvs_.count();
+    meshDecls.vertexUvData = uvs_.data();
+    meshDecls.vertexStride = uvs_.stride();
+
+    meshDecls.indexCount  = indices_.count();
+    meshDecls.indexData   = indices_.data();
+    meshDecls.indexFormat = indices_.format();
+
+    if (faceMaterials)
+    {
+        meshDecls.faceMaterialData = faceMaterials->data();
+    }
+
+    std::uint32_t const  meshCount = static_cast<std::uint32_t>(vertices.size() - 1);
+    std::uint32_t        added     = 0;
+    xatlas::AddMeshError error     = xatlas::AddMeshError::Success;
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed  = false;
+        m_lastInputCopied = uvs_.copied() || indices_.copied();
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        for (; added < meshCount && !m_progress->cancelled(); ++added)
+        {
+            xatlas::UvMeshDecl const meshDecl = sliceUvMeshDecl(meshDecls, vertices[added], vertices[added + 1], faces[added], faces[added + 1]);
+            hashUvMeshDecl(m_inputHash, meshDecl);
+
+            error = xatlas::AddUvMesh(m_atlas, meshDecl);
+            if (error != xatlas::AddMeshError::Success)
+            {
+                break;
+            }
+
+            m_vertexRemaps.emplace_back();
+        }
+    }
+
+    m_progress->throwIfCancelled();
+
+    if (error != xatlas::AddMeshError::Success)
+    {
+        throw std::runtime_error("Adding mesh " + std::to_string(added) + " failed: " + std::string(xatlas::StringForEnum(error)));
+    }
+}
+
+void Atlas::generate(xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions, bool verbose, std::optional<py::function> progressCallback, Cache* cache, std::optional<double> timeBudget, unsigned int numThreads)
+{
+    Timeline::Scope timing(m_timeline, "generate");
+
+    checkTimeBudget(timeBudget);
+
+    std::uint64_t const key = cache ? cacheKey(m_inputHash, chartOptions, packOptions, timeBudget) : 0;
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed = false;
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        generateNative(chartOptions, packOptions, cache, key, timeBudget, numThreads);
+    }
+
+    m_progress->throwIfCancelled();
+
+    if (verbose)
+    {
+        printStatistics();
+    }
+}
+
+py::object Atlas::generateAsync(xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions, std::optional<py::function> progressCallback, Cache* cache, std::optional<double> timeBudget, unsigned int numThreads)
+{
+    checkWritable();
+    checkTimeBudget(timeBudget);
+
+    // The job keeps the atlas and the cache alive
+    py::object const    self        = py::cast(this);
+    py::object const    cacheObject = cache ? py::cast(cache) : py::none();
+    std::uint64_t const key         = cache ? cacheKey(m_inputHash, chartOptions, packOptions, timeBudget) : 0;
+
+    // The atlas stays busy until the job finished, so it cannot be changed or read meanwhile
+    acquireBusy();
+
+    try
+    {
+        m_memory->rearm();
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed = false;
+        m_restored.reset();
+
+        return AsyncJob::submit(
+            [this, chartOptions, packOptions, cache, key, timeBudget, numThreads]() {
+                Timeline::Scope timing(m_timeline, "generate_async");
+                MemoryScope     memory(m_memory.get());
+                // The running jobs share the threads, as in `parametrize_batch`
+                generateNative(chartOptions, packOptions, cache, key, timeBudget, numThreads == 0 ? AsyncJob::threadShare() : numThreads);
+            },
+            [this, self, cacheObject]() {
+                m_busy = false;
+                m_progress->throwIfCancelled();
+                return py::none();
+            });
+    }
+    catch (...)
+    {
+        m_busy = false;
+        throw;
+    }
+}
+
+void Atlas::generateNative(xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions, Cache* cache, std::uint64_t key, std::optional<double> timeBudget, unsigned int numThreads)
+{
+    m_packingReport.reset();
+    xatlas::SetThreadCount(m_atlas, numThreads == 0 ? defaultThreadCount() : numThreads);
+
+    // The output of xatlas is deterministic, so a stored atlas replaces generating it
+    if (cache)
+    {
+        Timeline::Scope lookup(m_timeline, "cache_load");
+        m_restored = cache->load(key);
+        if (m_restored)
+        {
+            return;
+        }
+    }
+
+    if (timeBudget)
+    {
+        xatlas::ComputeCharts(m_atlas, chartOptions);
+        if (!m_progress->cancelled())
+        {
+            packNative(packOptions, timeBudget);
+        }
+    }
+    else
+    {
+        xatlas::Generate(m_atlas, chartOptions, packOptions);
+    }
+
+    // The charts of xatlas can be repacked, also if the best tiered packing was restored
+    m_chartsComputed = !m_progress->cancelled();
+
+    if (cache && !m_progress->cancelled())
+    {
+        Timeline::Scope store(m_timeline, "cache_store");
+        cache->store(key, output(), vertexRemaps());
+    }
+}
+
+void Atlas::packNative(xatlas::PackOptions const& packOptions, std::optional<double> timeBudget)
+{
+    if (!timeBudget)
+    {
+        m_packingReport.reset();
+        xatlas::PackCharts(m_atlas, packOptions);
+        return;
+    }
+
+    // Tiers of increasing quality and cost. The first one always completes, the others are stopped at the deadline.
+    struct Tier
+    {
+        char const* name;
+        bool        bruteForce;
+        bool        blockAlign;
+    };
+
+    std::vector<Tier> tiers{{"fast", false, packOptions.blockAlign}};
+    if (!packOptions.blockAlign)
+    {
+        tiers.push_back({"brute_force_block_aligned", true, true});
+    }
+    tiers.push_back({"brute_force", true, packOptions.blockAlign});
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point const start    = Clock::now();
+    Clock::time_point const deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(*timeBudget));
+
+    PackingReport     report{tiers[0].name, 0, 0.0, false};
+    std::vector<char> best;             // Serialized best packing (if it is not the current output of xatlas)
+    double            bestArea = 0.0;   // Total texels of all atlases, the smaller the better
+    bool              current  = false; // The current output of xatlas is the best packing
+
+    for (std::size_t i = 0; i < tiers.size(); ++i)
+    {
+        if (i > 0 && Clock::now() >= deadline)
+        {
+            report.deadlineReached = true;
+            break;
+        }
+
+        // Keep the best packing, since the next tier replaces the output of xatlas
+        if (current)
+        {
+            Timeline::Scope snapshot(m_timeline, "packing_snapshot");
+            best.resize(serializedSize(*m_atlas, m_atlas->image != nullptr));
+            serializeAtlas(*m_atlas, m_atlas->image != nullptr, best.data(), &m_vertexRemaps);
+        }
+
+        xatlas::PackOptions options = packOptions;
+        options.bruteForce          = tiers[i].bruteForce;
+        options.blockAlign          = tiers[i].blockAlign;
+
+        m_progress->setDeadline(i > 0 ? std::optional<Clock::time_point>(deadline) : std::nullopt);
+        xatlas::PackCharts(m_atlas, options);
+        bool const stopped = m_progress->deadlineReached();
+        m_progress->setDeadline(std::nullopt);
+
+        if (m_progress->cancelled())
+        {
+            return;
+        }
+
+        if (stopped)
+        {
+            report.deadlineReached = true;
+            current                = false;
+            break;
+        }
+
+        ++report.tiersCompleted;
+        double const area = double(m_atlas->atlasCount) * double(m_atlas->width) * double(m_atlas->height);
+        current           = i == 0 || area < bestArea;
+        if (current)
+        {
+            bestArea    = area;
+            report.tier = tiers[i].name;
+        }
+    }
+
+    // A later tier was stopped or did not improve on the best packing
+    if (!current)
+    {
+        Timeline::Scope restore(m_timeline, "packing_restore");
+        m_restored = RestoredAtlas::fromBuffer(std::move(best));
+    }
+
+    report.seconds  = std::chrono::duration<double>(Clock::now() - start).count();
+    m_packingReport = report;
+}
+
+void Atlas::computeCharts(xatlas::ChartOptions const& chartOptions, std::optional<py::function> progressCallback)
+{
+    Timeline::Scope timing(m_timeline, "compute_charts");
+
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_chartsComputed = false;
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        xatlas::ComputeCharts(m_atlas, chartOptions);
+    }
+
+    m_progress->throwIfCancelled();
+    m_chartsComputed = true;
+}
+
+void Atlas::packCharts(xatlas::PackOptions const& packOptions, bool verbose, std::optional<py::function> progressCallback, std::optional<double> timeBudget)
+{
+    Timeline::Scope timing(m_timeline, "pack_charts");
+
+    checkWritable();
+    checkTimeBudget(timeBudget);
+
+    // xatlas silently returns (with a warning) if the charts have not been computed
+    if (!m_chartsComputed)
+    {
+        throw std::runtime_error("Charts must be computed before they can be packed. Call compute_charts first.");
+    }
+
+    {
+        BusyScope busy(*this);
+        m_progress->setCallback(progressCallback);
+        m_restored.reset();
+
+        py::gil_scoped_release release;
+        packNative(packOptions, timeBudget);
+    }
+
+    m_progress->throwIfCancelled();
+
+    if (verbose)
+    {
+        printStatistics();
+    }
+}
+
+void Atlas::packIncremental(Atlas const& other, IncrementalOptions const& options, unsigned int numThreads)
+{
+    Timeline::Scope timing(m_timeline, "pack_incremental");
+
+    if (&other == this)
+    {
+        throw std::invalid_argument("An atlas cannot be packed into itself.");
+    }
+
+    // Neither atlas may change while the charts are placed
+    BusyScope busy(*this, false);
+    ReadScope reading(other);
+
+    xatlas::Atlas const& base  = output();
+    xatlas::Atlas const& added = other.output();
 
-    meshDecl.indexCount  = static_cast<std::uint32_t>(indices.size());
-    meshDecl.indexData   = indices.data();
-    meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
+    if (base.atlasCount == 0 || base.width == 0 || base.height == 0)
+    {
+        throw std::runtime_error("The atlas has not been generated.");
+    }
 
-    if (faceMaterials)
+    if (added.atlasCount == 0 || added.width == 0 || added.height == 0)
     {
-        meshDecl.faceMaterialData = faceMaterials->data();
+        throw std::runtime_error("The added atlas has not been generated.");
     }
 
-    xatlas::AddMeshError error = xatlas::AddUvMesh(m_atlas, meshDecl);
+    // Charts are placed as they are, so their scale must match
+    if (std::fabs(base.texelsPerUnit - added.texelsPerUnit) > 1e-4f * std::max(base.texelsPerUnit, added.texelsPerUnit))
+    {
+        throw std::invalid_argument("The added atlas must be generated with the same texels per unit (" + std::to_string(base.texelsPerUnit) + ") but has " + std::to_string(added.texelsPerUnit) + ".");
+    }
 
-    if (error != xatlas::AddMeshError::Success)
     {
-        throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
+        py::gil_scoped_release release;
+        std::unique_ptr<RestoredAtlas> composed = RestoredAtlas::fromBuffer(packIncremental(base, vertexRemaps(), added, other.vertexRemaps(), options, numThreads));
+
+        // The composed output refers to the original vertices of both atlases
+        m_restored       = std::move(composed);
+        m_readOnly       = true;
+        m_chartsComputed = false;
     }
 }
 
-void Atlas::generate(xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions, bool verbose)
+py::object Atlas::getMesh(std::uint32_t index, std::optional<OutputFormat> const& format) const
 {
-    xatlas::Generate(m_atlas, chartOptions, packOptions);
+    Timeline::Scope timing(m_timeline, "get_mesh");
 
-    if (verbose)
+    // The arrays are filled without the GIL, in either format
+    ReadScope reading(*this);
+
+    if (index >= output().meshCount)
+    {
+        throw std::out_of_range("Mesh index " + std::to_string(index) + " out of bounds for atlas with " + std::to_string(output().meshCount) + " meshes.");
+    }
+
+    VertexRemaps const*               remaps = vertexRemaps();
+    std::vector<std::uint32_t> const* remap  = remaps && index < remaps->size() && !(*remaps)[index].empty() ? &(*remaps)[index] : nullptr;
+    if (format)
     {
-        py::print("--- Generated Atlas ---");
-        py::print("Utilization: " + std::to_string(m_atlas->utilization[0] * 100.f) + "%");
-        py::print("Charts: " + std::to_string(m_atlas->chartCount));
-        py::print("Size: " + std::to_string(m_atlas->width) + "x" + std::to_string(m_atlas->height));
-        py::print("");
+        return encodeMesh(output(), index, remap, *format);
     }
+
+    return py::cast(meshToArrays(output(), index, remap));
 }
 
-MeshResult Atlas::getMesh(std::uint32_t index) const
+Meshes Atlas::getMeshes() const
 {
-    if (index >= m_atlas->meshCount)
+    Timeline::Scope timing(m_timeline, "get_meshes");
+
+    // The meshes are copied in parallel without the GIL
+    ReadScope reading(*this);
+
+    xatlas::Atlas const& atlas  = output();
+    VertexRemaps const*  remaps = vertexRemaps();
+
+    // Count the vertices and faces to allocate the outputs once
+    std::vector<std::size_t> vertexOffsets(atlas.meshCount + 1, 0);
+    std::vector<std::size_t> faceOffsets(atlas.meshCount + 1, 0);
+    for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
     {
-        throw std::out_of_range("Mesh index " + std::to_string(index) + " out of bounds for atlas with " + std::to_string(m_atlas->meshCount) + " meshes.");
+        vertexOffsets[m + 1] = vertexOffsets[m] + atlas.meshes[m].vertexCount;
+        faceOffsets[m + 1]   = faceOffsets[m] + atlas.meshes[m].indexCount / 3;
     }
 
-    auto const& mesh = m_atlas->meshes[index];
+    Meshes meshes;
+    meshes.mapping       = py::array_t<std::uint32_t>(py::array::ShapeContainer{vertexOffsets.back()});
+    meshes.indices       = py::array_t<std::uint32_t>(py::array::ShapeContainer{faceOffsets.back(), std::size_t(3)});
+    meshes.uvs           = py::array_t<float>(py::array::ShapeContainer{vertexOffsets.back(), std::size_t(2)});
+    meshes.vertexOffsets = py::array_t<std::uint32_t>(py::array::ShapeContainer{vertexOffsets.size()});
+    meshes.faceOffsets   = py::array_t<std::uint32_t>(py::array::ShapeContainer{faceOffsets.size()});
 
-    py::array_t<std::uint32_t> mapping(py::array::ShapeContainer{mesh.vertexCount});
-    py::array_t<float>         uvs(py::array::ShapeContainer{mesh.vertexCount, 2U});
+    std::uint32_t* mapping = meshes.mapping.mutable_data();
+    std::uint32_t* indices = meshes.indices.mutable_data();
+    float*         uvs     = meshes.uvs.mutable_data();
+    std::copy(vertexOffsets.begin(), vertexOffsets.end(), meshes.vertexOffsets.mutable_data());
+    std::copy(faceOffsets.begin(), faceOffsets.end(), meshes.faceOffsets.mutable_data());
 
-    auto mapping_ = mapping.mutable_unchecked<1>();
-    auto uvs_     = uvs.mutable_unchecked<2>();
-    for (size_t v = 0; v < static_cast<size_t>(mesh.vertexCount); ++v)
     {
-        auto const& vertex = mesh.vertexArray[v];
+        py::gil_scoped_release release;
+
+        // Split the meshes into blocks, so that many small meshes and few large ones are processed in parallel alike
+        struct Block
+        {
+            std::uint32_t mesh;
+            std::uint32_t begin;
+            std::uint32_t end;
+            bool          vertices;
+        };
+
+        constexpr std::uint32_t const blockSize = 1U << 16;
+        std::vector<Block>            blocks;
+        for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+        {
+            auto const& mesh = atlas.meshes[m];
+            for (std::uint32_t begin = 0; begin < mesh.vertexCount; begin += blockSize)
+            {
+                blocks.push_back({m, begin, std::min(mesh.vertexCount, begin + blockSize), true});
+            }
+            for (std::uint32_t begin = 0; begin < mesh.indexCount / 3; begin += blockSize)
+            {
+                blocks.push_back({m, begin, std::min(mesh.indexCount / 3, begin + blockSize), false});
+            }
+        }
 
-        mapping_(v) = vertex.xref;
+        parallelFor(blocks.size(), 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t b = first; b < last; ++b)
+            {
+                Block const& block = blocks[b];
+                auto const&  mesh  = atlas.meshes[block.mesh];
+                if (!block.vertices)
+                {
+                    std::size_t const offset = (faceOffsets[block.mesh] + block.begin) * 3;
+                    std::copy(mesh.indexArray + std::size_t(block.begin) * 3, mesh.indexArray + std::size_t(block.end) * 3, indices + offset);
+                    continue;
+                }
 
-        uvs_(v, 0) = vertex.uv[0] / m_atlas->width;
-        uvs_(v, 1) = vertex.uv[1] / m_atlas->height;
+                std::size_t const                 offset = vertexOffsets[block.mesh] + block.begin;
+                std::vector<std::uint32_t> const* remap  = remaps && block.mesh < remaps->size() && !(*remaps)[block.mesh].empty() ? &(*remaps)[block.mesh] : nullptr;
+                extractVertices(atlas, block.mesh, block.begin, block.end, remap, true,
+                                reinterpret_cast<char*>(mapping + offset), sizeof(std::uint32_t),
+                                reinterpret_cast<char*>(uvs + offset * 2), 2 * sizeof(float), UvEncoding::Float32);
+            }
+        });
     }
 
+    return meshes;
+}
+
+MeshResult Atlas::meshToArrays(xatlas::Atlas const& atlas, std::uint32_t index, std::vector<std::uint32_t> const* vertexRemap)
+{
+    auto const& mesh = atlas.meshes[index];
+
+    // Allocate the outputs once and fill them through raw pointers
+    py::array_t<std::uint32_t> mapping(py::array::ShapeContainer{mesh.vertexCount});
     py::array_t<std::uint32_t> indices(py::array::ShapeContainer{mesh.indexCount / 3, 3U});
+    py::array_t<float>         uvs(py::array::ShapeContainer{mesh.vertexCount, 2U});
+
+    std::uint32_t* mappingData = mapping.mutable_data();
+    std::uint32_t* indicesData = indices.mutable_data();
+    float*         uvsData     = uvs.mutable_data();
 
-    auto indices_ = indices.mutable_unchecked<2>();
-    for (size_t f = 0; f < static_cast<size_t>(mesh.indexCount) / 3; ++f)
     {
-        indices_(f, 0) = mesh.indexArray[f*3 + 0];
-        indices_(f, 1) = mesh.indexArray[f*3 + 1];
-        indices_(f, 2) = mesh.indexArray[f*3 + 2];
+        py::gil_scoped_release release;
+
+        std::copy_n(mesh.indexArray, (mesh.indexCount / 3) * 3, indicesData);
+
+        extractVertices(atlas, index, 0, mesh.vertexCount, vertexRemap, true,
+                        reinterpret_cast<char*>(mappingData), sizeof(std::uint32_t),
+                        reinterpret_cast<char*>(uvsData), 2 * sizeof(float), UvEncoding::Float32);
     }
 
     return std::make_tuple(mapping, indices, uvs);
@@ -178,12 +1086,14 @@ MeshResult Atlas::getMesh(std::uint32_t index) const
 
 VertexAssignment Atlas::getMeshVertexAssignment(std::uint32_t meshIndex) const
 {
-    if (meshIndex >= m_atlas->meshCount)
+    checkNotBusy();
+
+    if (meshIndex >= output().meshCount)
     {
-        throw std::out_of_range("Mesh index " + std::to_string(meshIndex) + " out of bounds for atlas with " + std::to_string(m_atlas->meshCount) + " meshes.");
+        throw std::out_of_range("Mesh index " + std::to_string(meshIndex) + " out of bounds for atlas with " + std::to_string(output().meshCount) + " meshes.");
     }
 
-    auto const& mesh = m_atlas->meshes[meshIndex];
+    auto const& mesh = output().meshes[meshIndex];
 
     py::array_t<std::uint32_t> atlasIndex(py::array::ShapeContainer{mesh.vertexCount});
     py::array_t<std::uint32_t> chartIndex(py::array::ShapeContainer{mesh.vertexCount});
@@ -201,20 +1111,24 @@ VertexAssignment Atlas::getMeshVertexAssignment(std::uint32_t meshIndex) const
 
 uint32_t Atlas::getMeshChartCount(std::uint32_t meshIndex) const
 {
-    if (meshIndex >= m_atlas->meshCount)
-        throw std::out_of_range("Mesh index " + std::to_string(meshIndex) + " out of bounds for atlas with " + std::to_string(m_atlas->meshCount) + " meshes.");
+    checkNotBusy();
+
+    if (meshIndex >= output().meshCount)
+        throw std::out_of_range("Mesh index " + std::to_string(meshIndex) + " out of bounds for atlas with " + std::to_string(output().meshCount) + " meshes.");
 
-    auto const& mesh = m_atlas->meshes[meshIndex];
+    auto const& mesh = output().meshes[meshIndex];
 
     return mesh.chartCount;
 }
 
 Chart Atlas::getMeshChart(std::uint32_t meshIndex, std::uint32_t chartIndex) const
 {
-    if (meshIndex >= m_atlas->meshCount)
-        throw std::out_of_range("Mesh index " + std::to_string(meshIndex) + " out of bounds for atlas with " + std::to_string(m_atlas->meshCount) + " meshes.");
+    checkNotBusy();
 
-    auto const& mesh = m_atlas->meshes[meshIndex];
+    if (meshIndex >= output().meshCount)
+        throw std::out_of_range("Mesh index " + std::to_string(meshIndex) + " out of bounds for atlas with " + std::to_string(output().meshCount) + " meshes.");
+
+    auto const& mesh = output().meshes[meshIndex];
 
     if (chartIndex >= mesh.chartCount)
         throw std::out_of_range("Chart index " + std::to_string(chartIndex) + " out of bounds for mesh with " + std::to_string(mesh.chartCount) + " charts.");
@@ -236,85 +1150,583 @@ Chart Atlas::getMeshChart(std::uint32_t meshIndex, std::uint32_t chartIndex) con
     return chart_;
 }
 
+Charts Atlas::getCharts(std::optional<std::uint32_t> meshIndex) const
+{
+    // The charts are gathered without the GIL
+    ReadScope reading(*this);
+
+    xatlas::Atlas const& atlas = output();
+
+    if (meshIndex && *meshIndex >= atlas.meshCount)
+        throw std::out_of_range("Mesh index " + std::to_string(*meshIndex) + " out of bounds for atlas with " + std::to_string(atlas.meshCount) + " meshes.");
+
+    std::uint32_t const firstMesh = meshIndex ? *meshIndex : 0U;
+    std::uint32_t const lastMesh  = meshIndex ? *meshIndex + 1U : atlas.meshCount;
+
+    // Count the charts and faces to allocate the outputs once
+    size_t chartCount = 0;
+    size_t faceCount  = 0;
+    for (std::uint32_t m = firstMesh; m < lastMesh; ++m)
+    {
+        auto const& mesh = atlas.meshes[m];
+        chartCount += mesh.chartCount;
+        for (std::uint32_t c = 0; c < mesh.chartCount; ++c)
+        {
+            faceCount += mesh.chartArray[c].faceCount;
+        }
+    }
+
+    Charts charts;
+    charts.faces      = py::array_t<std::uint32_t>(py::array::ShapeContainer{faceCount});
+    charts.offsets    = py::array_t<std::uint32_t>(py::array::ShapeContainer{chartCount + 1});
+    charts.meshIndex  = py::array_t<std::uint32_t>(py::array::ShapeContainer{chartCount});
+    charts.atlasIndex = py::array_t<std::uint32_t>(py::array::ShapeContainer{chartCount});
+    charts.type       = py::array_t<std::uint32_t>(py::array::ShapeContainer{chartCount});
+    charts.material   = py::array_t<std::uint32_t>(py::array::ShapeContainer{chartCount});
+
+    std::uint32_t* faces     = charts.faces.mutable_data();
+    std::uint32_t* offsets   = charts.offsets.mutable_data();
+    std::uint32_t* meshes    = charts.meshIndex.mutable_data();
+    std::uint32_t* atlases   = charts.atlasIndex.mutable_data();
+    std::uint32_t* types     = charts.type.mutable_data();
+    std::uint32_t* materials = charts.material.mutable_data();
+
+    // Fill all arrays in one pass
+    {
+        py::gil_scoped_release release;
+
+        size_t chart  = 0;
+        size_t offset = 0;
+        for (std::uint32_t m = firstMesh; m < lastMesh; ++m)
+        {
+            auto const& mesh = atlas.meshes[m];
+            for (std::uint32_t c = 0; c < mesh.chartCount; ++c, ++chart)
+            {
+                auto const& chart_ = mesh.chartArray[c];
+
+                offsets[chart]   = static_cast<std::uint32_t>(offset);
+                meshes[chart]    = m;
+                atlases[chart]   = chart_.atlasIndex;
+                types[chart]     = static_cast<std::uint32_t>(chart_.type);
+                materials[chart] = chart_.material;
+
+                std::copy_n(chart_.faceArray, chart_.faceCount, faces + offset);
+                offset += chart_.faceCount;
+            }
+        }
+        offsets[chart] = static_cast<std::uint32_t>(offset);
+    }
+
+    return charts;
+}
+
 float Atlas::getUtilization(std::uint32_t index) const
 {
-    if (index >= m_atlas->atlasCount)
+    checkNotBusy();
+
+    if (index >= output().atlasCount)
     {
         throw std::out_of_range("Atlas index " + std::to_string(index) + " out of bounds.");
     }
 
-    return m_atlas->utilization[index];
+    return output().utilization[index];
 }
 
-py::array_t<std::uint8_t> Atlas::getChartImage(std::uint32_t index) const
+py::array_t<std::uint8_t> Atlas::getChartImage(std::optional<std::uint32_t> index) const
 {
     // Code inspired by xatlas::writeTga
 
-    if (index >= m_atlas->atlasCount)
+    // The image and the charts are read without the GIL
+    ReadScope reading(*this);
+
+    xatlas::Atlas const& atlas = output();
+
+    if (index && *index >= atlas.atlasCount)
     {
-        throw std::out_of_range("Atlas index " + std::to_string(index) + " out of bounds.");
+        throw std::out_of_range("Atlas index " + std::to_string(*index) + " out of bounds.");
     }
 
-    if (!m_atlas->image || m_atlas->width == 0 || m_atlas->height == 0)
+    if (!atlas.image || atlas.width == 0 || atlas.height == 0)
     {
         throw std::runtime_error("The atlas does not have an image.");
     }
 
-    // Generate a color for each chart
-    std::vector<std::array<uint8_t, 3>>         chartColors(m_atlas->chartCount);
-    std::uniform_int_distribution<unsigned int> distribution(0, 254); // Original code uses `% 255`, which excludes 255
-    constexpr unsigned int const                mix        = 192U;
-    size_t                                      chartIndex = 0U;
-    for (auto& color : chartColors)
+    // Palette of all texel classes: empty, padding, bilinear and one color per chart
+    constexpr std::size_t const  emptyColor    = 0;
+    constexpr std::size_t const  paddingColor  = 1;
+    constexpr std::size_t const  bilinearColor = 2;
+    constexpr std::size_t const  chartColors   = 3;
+    std::vector<std::array<uint8_t, 3>> palette(chartColors + atlas.chartCount);
+    palette[emptyColor]    = {0, 0, 0};
+    palette[paddingColor]  = {0, 0, 255};
+    palette[bilinearColor] = {0, 255, 0};
+
+    // The color of a chart only depends on its index, so charts can be colored in parallel
+    parallelFor(atlas.chartCount, 4096, [&](std::size_t begin, std::size_t end) {
+        std::uniform_int_distribution<unsigned int> distribution(0, 254); // Original code uses `% 255`, which excludes 255
+        constexpr unsigned int const                mix = 192U;
+        for (std::size_t chartIndex = begin; chartIndex < end; ++chartIndex)
+        {
+            std::default_random_engine engine(static_cast<unsigned int>(chartIndex));
+            auto&                      color = palette[chartColors + chartIndex];
+            color[0] = static_cast<std::uint8_t>((distribution(engine) + mix) * 0.5f);
+            color[1] = static_cast<std::uint8_t>((distribution(engine) + mix) * 0.5f);
+            color[2] = static_cast<std::uint8_t>((distribution(engine) + mix) * 0.5f);
+        }
+    });
+
+    // Fill an image with the chart colors (all atlases without an index)
+    std::size_t const first = index ? *index : 0;
+    std::size_t const count = index ? 1 : atlas.atlasCount;
+    py::array_t<std::uint8_t> image = index ? py::array_t<std::uint8_t>(py::array::ShapeContainer{ atlas.height, atlas.width, 3U })
+                                            : py::array_t<std::uint8_t>(py::array::ShapeContainer{ atlas.atlasCount, atlas.height, atlas.width, 3U });
+
+    std::uint32_t const* source = atlas.image + first * atlas.width * atlas.height;
+    std::uint8_t*        target = image.mutable_data();
+    std::size_t const    width  = atlas.width;
+    std::size_t const    charts = atlas.chartCount;
+    {
+        py::gil_scoped_release release;
+        parallelFor(count * atlas.height, 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin * width; i < end * width; ++i)
+            {
+                std::uint32_t const data       = source[i];
+                std::size_t const   chartIndex = data & xatlas::kImageChartIndexMask;
+
+                std::size_t color = emptyColor;
+                if (data & xatlas::kImageIsPaddingBit)
+                {
+                    color = paddingColor;
+                }
+                else if (data & xatlas::kImageIsBilinearBit)
+                {
+                    color = bilinearColor;
+                }
+                else if (data != 0 && chartIndex < charts)
+                {
+                    color = chartColors + chartIndex;
+                }
+
+                std::copy_n(palette[color].data(), 3, target + i * 3);
+            }
+        });
+    }
+
+    return image;
+}
+
+py::array_t<std::uint32_t> Atlas::getChartIdImage() const
+{
+    checkNotBusy();
+
+    xatlas::Atlas const& atlas = output();
+
+    if (!atlas.image || atlas.width == 0 || atlas.height == 0)
     {
-        std::default_random_engine engine(static_cast<unsigned int>(chartIndex++));
-        color[0] = static_cast<std::uint8_t>((distribution(engine) + mix) * 0.5f) ;
-        color[1] = static_cast<std::uint8_t>((distribution(engine) + mix) * 0.5f);
-        color[2] = static_cast<std::uint8_t>((distribution(engine) + mix) * 0.5f);
+        throw std::runtime_error("The atlas does not have an image.");
     }
 
-    // Fill an image with the chart colors
-    py::array_t<std::uint8_t> image(py::array::ShapeContainer{ m_atlas->height, m_atlas->width, 3U });
+    // The array references the image of the atlas, which stays alive (and unmodified) as long as the array does
+    struct Export
+    {
+        py::object   owner;
+        Atlas const* atlas;
+    };
+
+    ++m_imageExports;
+    py::capsule base(new Export{py::cast(this), this}, [](void* pointer) {
+        Export* export_ = static_cast<Export*>(pointer);
+        --export_->atlas->m_imageExports;
+        delete export_;
+    });
 
-    size_t offset = m_atlas->width * m_atlas->height * index;
-    auto image_ = image.mutable_unchecked<3>();
-    for (uint32_t y = 0; y < m_atlas->height; ++y)
+    py::array_t<std::uint32_t> image(py::array::ShapeContainer{ atlas.atlasCount, atlas.height, atlas.width }, atlas.image, base);
+    image.attr("setflags")(py::arg("write") = false);
+    return image;
+}
+
+py::dict Atlas::bakeGeometry(std::optional<std::vector<py::object>> positions, std::optional<std::vector<py::object>> normals, bool conservative, unsigned int numThreads) const
+{
+    Timeline::Scope timing(m_timeline, "bake_geometry");
+
+    // The atlas is rasterized without the GIL
+    ReadScope reading(*this);
+
+    xatlas::Atlas const& atlas = output();
+
+    if (atlas.atlasCount == 0 || atlas.width == 0 || atlas.height == 0)
     {
-        for (uint32_t x = 0; x < m_atlas->width; ++x)
+        throw std::runtime_error("The atlas has not been generated.");
+    }
+
+    // Per-mesh attributes, converted once and referenced while baking
+    std::vector<BakeMesh>     meshes(atlas.meshCount);
+    std::vector<VertexBuffer> buffers;
+    buffers.reserve(2 * atlas.meshCount);
+
+    VertexRemaps const* remaps    = vertexRemaps();
+    auto const          addBuffer = [&](std::optional<std::vector<py::object>> const& arrays, std::string const& name, bool isPosition) {
+        if (!arrays)
         {
-            uint32_t const data = m_atlas->image[x + y * m_atlas->width + offset];
+            return;
+        }
 
-            if (data == 0)
-            {
-                image_(y, x, 0) = image_(y, x, 1) = image_(y, x, 2) = 0;
-                continue;
-            }
+        if (arrays->size() != atlas.meshCount)
+        {
+            throw std::invalid_argument("Expected " + std::to_string(atlas.meshCount) + " " + name + " arrays (one per mesh) but got " + std::to_string(arrays->size()) + ".");
+        }
 
-            const uint32_t chartIndex = data & xatlas::kImageChartIndexMask;
-            if (data & xatlas::kImageIsPaddingBit)
-            {
-                image_(y, x, 0) = 0;
-                image_(y, x, 1) = 0;
-                image_(y, x, 2) = 255;
-            }
-            else if (data & xatlas::kImageIsBilinearBit)
+        for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+        {
+            VertexBuffer const& buffer = buffers.emplace_back(name, (*arrays)[m], 3);
+            BakeMesh&           mesh   = meshes[m];
+            if (isPosition)
             {
-                image_(y, x, 0) = 0;
-                image_(y, x, 1) = 255;
-                image_(y, x, 2) = 0;
+                mesh.positions      = static_cast<float const*>(buffer.data());
+                mesh.positionStride = buffer.stride();
             }
             else
             {
-                auto color = chartColors[chartIndex];
-
-                image_(y, x, 0) = color[0];
-                image_(y, x, 1) = color[1];
-                image_(y, x, 2) = color[2];
+                mesh.normals      = static_cast<float const*>(buffer.data());
+                mesh.normalStride = buffer.stride();
             }
+            mesh.vertexCount = (mesh.positions && mesh.normals) ? std::min(mesh.vertexCount, buffer.count()) : buffer.count();
+            mesh.vertexRemap = (remaps && m < remaps->size() && !(*remaps)[m].empty()) ? &(*remaps)[m] : nullptr;
         }
+    };
+    addBuffer(positions, "Position", true);
+    addBuffer(normals, "Normal", false);
+
+    py::array::ShapeContainer const   shape{atlas.atlasCount, atlas.height, atlas.width};
+    py::array::ShapeContainer const   vectorShape{atlas.atlasCount, atlas.height, atlas.width, 3U};
+    py::array_t<std::int32_t>         meshIndex(shape);
+    py::array_t<std::int32_t>         triangleIndex(shape);
+    py::array_t<float>                barycentrics(vectorShape);
+    std::optional<py::array_t<float>> bakedPositions;
+    std::optional<py::array_t<float>> bakedNormals;
+
+    BakeOutput output;
+    output.meshIndex     = meshIndex.mutable_data();
+    output.triangleIndex = triangleIndex.mutable_data();
+    output.barycentrics  = barycentrics.mutable_data();
+    if (positions)
+    {
+        bakedPositions.emplace(vectorShape);
+        output.positions = bakedPositions->mutable_data();
+    }
+    if (normals)
+    {
+        bakedNormals.emplace(vectorShape);
+        output.normals = bakedNormals->mutable_data();
     }
 
-    return image;
+    {
+        py::gil_scoped_release release;
+        ::bakeGeometry(atlas, meshes, output, conservative, numThreads);
+    }
+
+    py::dict result;
+    result["mesh_index"]     = meshIndex;
+    result["triangle_index"] = triangleIndex;
+    result["barycentrics"]   = barycentrics;
+    if (bakedPositions)
+    {
+        result["position"] = *bakedPositions;
+    }
+    if (bakedNormals)
+    {
+        result["normal"] = *bakedNormals;
+    }
+    return result;
+}
+
+py::array Atlas::remapTexture(py::object const& textures, std::vector<py::object> const& uvs, std::uint32_t dilation, unsigned int numThreads) const
+{
+    Timeline::Scope timing(m_timeline, "remap_texture");
+
+    // The atlas is rasterized without the GIL
+    ReadScope reading(*this);
+
+    xatlas::Atlas const& atlas = output();
+
+    if (atlas.atlasCount == 0 || atlas.width == 0 || atlas.height == 0)
+    {
+        throw std::runtime_error("The atlas has not been generated.");
+    }
+
+    if (uvs.size() != atlas.meshCount)
+    {
+        throw std::invalid_argument("Expected " + std::to_string(atlas.meshCount) + " texture coordinate arrays (one per mesh) but got " + std::to_string(uvs.size()) + ".");
+    }
+
+    // One texture for all meshes or one per mesh
+    std::vector<py::object> sources;
+    if (py::isinstance<py::list>(textures) || py::isinstance<py::tuple>(textures))
+    {
+        sources = textures.cast<std::vector<py::object>>();
+        if (sources.size() != atlas.meshCount)
+        {
+            throw std::invalid_argument("Expected " + std::to_string(atlas.meshCount) + " textures (one per mesh) but got " + std::to_string(sources.size()) + ".");
+        }
+    }
+    else
+    {
+        sources.assign(atlas.meshCount, textures);
+    }
+
+    // uint8 textures stay uint8, everything else is resampled as float32
+    bool const floatTexels = std::any_of(sources.begin(), sources.end(), [](py::object const& source) {
+        return !py::isinstance<py::array_t<std::uint8_t>>(source);
+    });
+
+    std::vector<py::array>   arrays;
+    std::vector<TextureView> views;
+    for (auto const& source : sources)
+    {
+        py::array array = floatTexels ? py::array(py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(source))
+                                      : py::array(py::array_t<std::uint8_t, py::array::c_style | py::array::forcecast>::ensure(source));
+        if (!array || (array.ndim() != 2 && array.ndim() != 3) || array.shape(0) == 0 || array.shape(1) == 0)
+        {
+            throw std::invalid_argument("Textures must be non-empty (height, width) or (height, width, channels) arrays.");
+        }
+
+        TextureView view;
+        view.data     = array.data();
+        view.height   = static_cast<std::uint32_t>(array.shape(0));
+        view.width    = static_cast<std::uint32_t>(array.shape(1));
+        view.channels = array.ndim() == 3 ? static_cast<std::uint32_t>(array.shape(2)) : 1U;
+        if (!views.empty() && (view.channels != views[0].channels || array.ndim() != arrays[0].ndim()))
+        {
+            throw std::invalid_argument("All textures must have the same number of channels.");
+        }
+
+        arrays.push_back(std::move(array));
+        views.push_back(view);
+    }
+
+    std::vector<BakeMesh>     meshes(atlas.meshCount);
+    std::vector<VertexBuffer> buffers;
+    buffers.reserve(atlas.meshCount);
+
+    VertexRemaps const* remaps = vertexRemaps();
+    for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+    {
+        VertexBuffer const& buffer = buffers.emplace_back("Texture coordinate", uvs[m], 2);
+        BakeMesh&           mesh   = meshes[m];
+        mesh.uvs         = static_cast<float const*>(buffer.data());
+        mesh.uvStride    = buffer.stride();
+        mesh.vertexCount = buffer.count();
+        mesh.vertexRemap = (remaps && m < remaps->size() && !(*remaps)[m].empty()) ? &(*remaps)[m] : nullptr;
+    }
+
+    py::array::ShapeContainer shape{atlas.atlasCount, atlas.height, atlas.width};
+    if (arrays[0].ndim() == 3)
+    {
+        shape->push_back(views[0].channels);
+    }
+
+    py::array result = floatTexels ? py::array(py::array_t<float>(shape)) : py::array(py::array_t<std::uint8_t>(shape));
+    void*     data   = result.mutable_data();
+
+    {
+        py::gil_scoped_release release;
+        ::remapTexture(atlas, meshes, views, floatTexels, data, dilation, numThreads);
+    }
+
+    return result;
+}
+
+py::dict Atlas::getStats() const
+{
+    checkNotBusy();
+
+    xatlas::Atlas const& atlas = output();
+
+    auto const toDict = [](std::map<std::string, Timeline::Total> const& totals) {
+        py::dict result;
+        for (auto const& [name, total] : totals)
+        {
+            result[py::str(name)] = py::dict(py::arg("count") = total.count, py::arg("seconds") = total.seconds);
+        }
+        return result;
+    };
+
+    std::vector<std::uint32_t> chartsPerMesh;
+    size_t                     vertexCount = 0;
+    size_t                     indexCount  = 0;
+    for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+    {
+        chartsPerMesh.push_back(atlas.meshes[m].chartCount);
+        vertexCount += atlas.meshes[m].vertexCount;
+        indexCount += atlas.meshes[m].indexCount;
+    }
+
+    std::vector<float> utilization(atlas.utilization, atlas.utilization + (atlas.utilization ? atlas.atlasCount : 0));
+
+    py::dict counters;
+    counters["mesh_count"]      = atlas.meshCount;
+    counters["chart_count"]     = atlas.chartCount;
+    counters["charts_per_mesh"] = chartsPerMesh;
+    counters["atlas_count"]     = atlas.atlasCount;
+    counters["width"]           = atlas.width;
+    counters["height"]          = atlas.height;
+    counters["texels_per_unit"] = atlas.texelsPerUnit;
+    counters["utilization"]     = utilization;
+    counters["vertex_count"]    = vertexCount;
+    counters["face_count"]      = indexCount / 3;
+
+    py::dict memory;
+    memory["current_bytes"]    = m_memory->currentBytes();
+    memory["peak_bytes"]       = m_memory->peakBytes();
+    memory["allocation_count"] = m_memory->allocationCount();
+
+    py::dict stats;
+    stats["operations"] = toDict(m_timeline.operations());
+    stats["stages"]     = toDict(m_timeline.stages());
+    stats["counters"]   = counters;
+    stats["memory"]     = memory;
+
+    if (m_packingReport)
+    {
+        py::dict packing;
+        packing["tier"]             = m_packingReport->tier;
+        packing["tiers_completed"]  = m_packingReport->tiersCompleted;
+        packing["seconds"]          = m_packingReport->seconds;
+        packing["deadline_reached"] = m_packingReport->deadlineReached;
+        packing["utilization"]      = utilization;
+        stats["packing"]            = packing;
+    }
+
+    return stats;
+}
+
+void Atlas::writeTrace(std::string const& path) const
+{
+    checkNotBusy();
+
+    m_timeline.writeTrace(path);
+}
+
+void Atlas::save(std::string const& path, bool includeImage) const
+{
+    Timeline::Scope timing(m_timeline, "save");
+
+    // The output is written without the GIL
+    ReadScope reading(*this);
+
+    py::gil_scoped_release release;
+    saveAtlas(output(), includeImage, path, vertexRemaps());
+}
+
+std::unique_ptr<Atlas> Atlas::load(std::string const& path, bool map)
+{
+    std::unique_ptr<RestoredAtlas> restored;
+    {
+        py::gil_scoped_release release;
+        restored = RestoredAtlas::fromFile(path, map);
+    }
+
+    return std::unique_ptr<Atlas>(new Atlas(std::move(restored)));
+}
+
+py::bytes Atlas::toBytes(bool includeImage) const
+{
+    checkNotBusy();
+
+    xatlas::Atlas const& atlas = output();
+    std::size_t const    size  = serializedSize(atlas, includeImage);
+
+    // Serialize directly into the bytes object instead of an intermediate buffer
+    py::bytes bytes = py::reinterpret_steal<py::bytes>(PyBytes_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(size)));
+    if (!bytes)
+    {
+        throw py::error_already_set();
+    }
+
+    serializeAtlas(atlas, includeImage, PyBytes_AsString(bytes.ptr()), vertexRemaps());
+
+    return bytes;
+}
+
+std::unique_ptr<Atlas> Atlas::fromBytes(py::bytes const& bytes)
+{
+    char*      data;
+    Py_ssize_t size;
+    if (PyBytes_AsStringAndSize(bytes.ptr(), &data, &size) != 0)
+    {
+        throw py::error_already_set();
+    }
+
+    // The bytes object is not guaranteed to be suitably aligned and may be released, so the data is copied once
+    return std::unique_ptr<Atlas>(new Atlas(RestoredAtlas::fromBuffer(std::vector<char>(data, data + size))));
+}
+
+VertexRemaps const* Atlas::vertexRemaps() const
+{
+    // Restored outputs already refer to the original vertices
+    return m_restored ? nullptr : &m_vertexRemaps;
+}
+
+xatlas::Atlas const& Atlas::output() const
+{
+    // Output restored from a file or from a cache
+    return m_restored ? m_restored->atlas() : *m_atlas;
+}
+
+void Atlas::checkWritable() const
+{
+    if (m_readOnly)
+    {
+        throw std::runtime_error("The atlas was restored from serialized data or packed incrementally and is read-only.");
+    }
+
+    checkNotExported();
+}
+
+void Atlas::checkNotExported() const
+{
+    if (m_imageExports > 0)
+    {
+        throw std::runtime_error("The atlas cannot be modified while arrays returned by `chart_id_image` are referenced.");
+    }
+}
+
+void Atlas::checkNotBusy() const
+{
+    if (m_busy)
+    {
+        throw std::runtime_error("The atlas is in use by another thread.");
+    }
+}
+
+void Atlas::acquireBusy() const
+{
+    if (m_busy.exchange(true))
+    {
+        throw std::runtime_error("The atlas is in use by another thread.");
+    }
+
+    if (m_readers > 0)
+    {
+        m_busy = false;
+        throw std::runtime_error("The atlas is in use by another thread.");
+    }
+}
+
+xatlas::Atlas const& Atlas::checkedOutput() const
+{
+    checkNotBusy();
+
+    return output();
+}
+
+void Atlas::printStatistics() const
+{
+    py::print("--- Generated Atlas ---");
+    py::print("Utilization: " + std::to_string(output().utilization[0] * 100.f) + "%");
+    py::print("Charts: " + std::to_string(output().chartCount));
+    py::print("Size: " + std::to_string(output().width) + "x" + std::to_string(output().height));
+    py::print("");
 }
 
 void Atlas::bind(py::module& m)
@@ -325,27 +1737,76 @@ void Atlas::bind(py::module& m)
         .def_property_readonly("type", [](Chart const& self) { return self.type; })
         .def_property_readonly("material", [](Chart const& self) { return self.material; });
 
+    py::class_<Charts>(m, "Charts")
+        .def_property_readonly("faces", [](Charts const& self) { return self.faces; })
+        .def_property_readonly("offsets", [](Charts const& self) { return self.offsets; })
+        .def_property_readonly("mesh_index", [](Charts const& self) { return self.meshIndex; })
+        .def_property_readonly("atlas_index", [](Charts const& self) { return self.atlasIndex; })
+        .def_property_readonly("type", [](Charts const& self) { return self.type; })
+        .def_property_readonly("material", [](Charts const& self) { return self.material; })
+        .def("__len__", [](Charts const& self) { return self.meshIndex.size(); });
+
+    py::class_<Meshes>(m, "Meshes")
+        .def_property_readonly("mapping", [](Meshes const& self) { return self.mapping; })
+        .def_property_readonly("indices", [](Meshes const& self) { return self.indices; })
+        .def_property_readonly("uvs", [](Meshes const& self) { return self.uvs; })
+        .def_property_readonly("vertex_offsets", [](Meshes const& self) { return self.vertexOffsets; })
+        .def_property_readonly("face_offsets", [](Meshes const& self) { return self.faceOffsets; })
+        .def("__len__", [](Meshes const& self) { return self.vertexOffsets.size() - 1; });
+
     py::class_<Atlas>(m, "Atlas")
-        .def(py::init<>())
-        .def("add_mesh", &Atlas::addMesh, py::arg("positions"), py::arg("indices"), py::arg("normals") = std::nullopt, py::arg("uvs") = std::nullopt)
-        .def("add_uv_mesh", &Atlas::addUvMesh, py::arg("uvs"), py::arg("indices"), py::arg("face_materials") = std::nullopt)
-        .def("generate", &Atlas::generate, py::arg("chart_options") = xatlas::ChartOptions(), py::arg("pack_options") = xatlas::PackOptions(), py::arg("verbose") = false)
-        .def("get_mesh", &Atlas::getMesh, py::arg("mesh_index"))
+        .def(py::init<bool, std::optional<std::size_t>>(), py::arg("pool_allocator") = false, py::arg("memory_budget") = std::nullopt)
+        .def("add_mesh", &Atlas::addMesh, py::arg("positions"), py::arg("indices"), py::arg("normals") = std::nullopt, py::arg("uvs") = std::nullopt, py::arg("progress_callback") = std::nullopt, py::arg("weld") = std::nullopt)
+        .def("add_mesh_from_file", &Atlas::addMeshFromFile, py::arg("path"), py::arg("num_threads") = 0, py::arg("progress_callback") = std::nullopt, py::arg("weld") = std::nullopt)
+        .def("add_uv_mesh", &Atlas::addUvMesh, py::arg("uvs"), py::arg("indices"), py::arg("face_materials") = std::nullopt, py::arg("progress_callback") = std::nullopt)
+        .def("add_meshes", &Atlas::addMeshes, py::arg("positions"), py::arg("indices"), py::arg("vertex_offsets"), py::arg("face_offsets"), py::arg("normals") = std::nullopt, py::arg("uvs") = std::nullopt, py::arg("progress_callback") = std::nullopt, py::arg("weld") = std::nullopt)
+        .def("add_uv_meshes", &Atlas::addUvMeshes, py::arg("uvs"), py::arg("indices"), py::arg("vertex_offsets"), py::arg("face_offsets"), py::arg("face_materials") = std::nullopt, py::arg("progress_callback") = std::nullopt)
+        .def("generate", &Atlas::generate, py::arg("chart_options") = xatlas::ChartOptions(), py::arg("pack_options") = xatlas::PackOptions(), py::arg("verbose") = false, py::arg("progress_callback") = std::nullopt, py::arg("cache") = nullptr, py::arg("time_budget") = std::nullopt, py::arg("num_threads") = 0)
+        .def("generate_async", &Atlas::generateAsync, py::arg("chart_options") = xatlas::ChartOptions(), py::arg("pack_options") = xatlas::PackOptions(), py::arg("progress_callback") = std::nullopt, py::arg("cache") = nullptr, py::arg("time_budget") = std::nullopt, py::arg("num_threads") = 0)
+        .def("compute_charts", &Atlas::computeCharts, py::arg("chart_options") = xatlas::ChartOptions(), py::arg("progress_callback") = std::nullopt)
+        .def("pack_charts", &Atlas::packCharts, py::arg("pack_options") = xatlas::PackOptions(), py::arg("verbose") = false, py::arg("progress_callback") = std::nullopt, py::arg("time_budget") = std::nullopt)
+        .def("pack_incremental", [](Atlas& self, Atlas const& other, std::uint32_t padding, bool grow, std::uint32_t maxSize, bool spill, unsigned int numThreads) {
+                IncrementalOptions options;
+                options.padding = padding;
+                options.grow    = grow;
+                options.maxSize = maxSize;
+                options.spill   = spill;
+                self.packIncremental(other, options, numThreads);
+            }, py::arg("other"), py::arg("padding") = 1, py::arg("grow") = false, py::arg("max_size") = 0, py::arg("spill") = true, py::arg("num_threads") = 0)
+        .def("get_mesh", &Atlas::getMesh, py::arg("mesh_index"), py::arg("format") = std::nullopt)
+        .def("get_meshes", &Atlas::getMeshes)
         .def("get_mesh_vertex_assignment", &Atlas::getMeshVertexAssignment, py::arg("mesh_index"))
         .def("get_mesh_chart_count", &Atlas::getMeshChartCount, py::arg("mesh_index"))
         .def("get_mesh_chart", &Atlas::getMeshChart, py::arg("mesh_index"), py::arg("chart_index"))
+        .def("get_charts", &Atlas::getCharts, py::arg("mesh_index") = std::nullopt)
         .def("get_utilization", &Atlas::getUtilization, py::arg("atlas_index"))
-        .def("get_chart_image", &Atlas::getChartImage, py::arg("atlas_index"))
-        .def_property_readonly("atlas_count", [](Atlas const& self) { return self.m_atlas->atlasCount; })
-        .def_property_readonly("mesh_count", [](Atlas const& self) { return self.m_atlas->meshCount; })
-        .def_property_readonly("chart_count", [](Atlas const& self) { return self.m_atlas->chartCount; })
-        .def_property_readonly("width", [](Atlas const& self) { return self.m_atlas->width; })
-        .def_property_readonly("height", [](Atlas const& self) { return self.m_atlas->height; })
-        .def_property_readonly("texels_per_unit", [](Atlas const& self) { return self.m_atlas->texelsPerUnit; })
+        .def("get_chart_image", &Atlas::getChartImage, py::arg("atlas_index") = std::nullopt)
+        .def("bake_geometry", &Atlas::bakeGeometry, py::arg("positions") = std::nullopt, py::arg("normals") = std::nullopt, py::arg("conservative") = true, py::arg("num_threads") = 0)
+        .def("remap_texture", &Atlas::remapTexture, py::arg("textures"), py::arg("uvs"), py::arg("dilation") = 4, py::arg("num_threads") = 0)
+        .def("write_trace", &Atlas::writeTrace, py::arg("path"))
+        .def("save", &Atlas::save, py::arg("path"), py::arg("include_image") = true)
+        .def_static("load", &Atlas::load, py::arg("path"), py::arg("mmap") = true)
+        .def("to_bytes", &Atlas::toBytes, py::arg("include_image") = true)
+        .def_static("from_bytes", &Atlas::fromBytes, py::arg("data"))
+        .def(py::pickle([](Atlas const& self) { return self.toBytes(true); }, &Atlas::fromBytes))
+        .def_property_readonly("stats", &Atlas::getStats)
+        .def_property_readonly("current_bytes", [](Atlas const& self) { return self.m_memory->currentBytes(); })
+        .def_property_readonly("peak_bytes", [](Atlas const& self) { return self.m_memory->peakBytes(); })
+        .def_property_readonly("allocation_count", [](Atlas const& self) { return self.m_memory->allocationCount(); })
+        .def_property_readonly("memory_budget", [](Atlas const& self) { return self.m_memory->budget(); }, "Bytes above which an operation is cancelled at its next progress update with MemoryBudgetError. Allocations are never refused, so the peak may exceed the budget.")
+        .def_property_readonly("last_input_copied", [](Atlas const& self) { return self.m_lastInputCopied; })
+        .def_property_readonly("restored", [](Atlas const& self) { return self.m_readOnly; })
+        .def_property_readonly("atlas_count", [](Atlas const& self) { return self.checkedOutput().atlasCount; })
+        .def_property_readonly("mesh_count", [](Atlas const& self) { return self.checkedOutput().meshCount; })
+        .def_property_readonly("chart_count", [](Atlas const& self) { return self.checkedOutput().chartCount; })
+        .def_property_readonly("width", [](Atlas const& self) { return self.checkedOutput().width; })
+        .def_property_readonly("height", [](Atlas const& self) { return self.checkedOutput().height; })
+        .def_property_readonly("texels_per_unit", [](Atlas const& self) { return self.checkedOutput().texelsPerUnit; })
         .def_property_readonly("utilization", [](Atlas const& self){ return self.getUtilization(0); })
         .def_property_readonly("chart_image", [](Atlas const& self){ return self.getChartImage(0); })
+        .def_property_readonly("chart_id_image", &Atlas::getChartIdImage)
 
         // Convenience bindings
-        .def("__len__", [](Atlas const& self) { return self.m_atlas->meshCount; })
-        .def("__getitem__", &Atlas::getMesh);
+        .def("__len__", [](Atlas const& self) { return self.checkedOutput().meshCount; })
+        .def("__getitem__", [](Atlas const& self, std::uint32_t index) { return self.getMesh(index); });
 }
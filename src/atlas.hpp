@@ -24,15 +24,30 @@
 
 #pragma once
 
+#include "buffers.hpp"
+#include "cache.hpp"
+#include "format.hpp"
+#include "hash.hpp"
+#include "incremental.hpp"
+#include "memory.hpp"
+#include "progress.hpp"
+#include "serialization.hpp"
+#include "timeline.hpp"
 #include "utils.hpp"
+#include "weld.hpp"
 
 #include <pybind11/pybind11.h>
 
 #include <xatlas.h>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <string>
 #include <tuple>
+#include <vector>
 
 using MeshResult = std::tuple<
     pybind11::array_t<std::uint32_t>, 
@@ -53,25 +68,119 @@ struct Chart
     uint32_t                         material;
 };
 
+// All charts of one mesh or of the whole atlas in flat arrays.
+// The faces of chart i are `faces[offsets[i]:offsets[i + 1]]`.
+struct Charts
+{
+    pybind11::array_t<std::uint32_t> faces;      // Face indices (relative to the chart's mesh)
+    pybind11::array_t<std::uint32_t> offsets;    // Offsets into `faces` (number of charts + 1)
+    pybind11::array_t<std::uint32_t> meshIndex;  // Mesh of each chart
+    pybind11::array_t<std::uint32_t> atlasIndex; // Sub-atlas index of each chart
+    pybind11::array_t<std::uint32_t> type;       // xatlas::ChartType of each chart
+    pybind11::array_t<std::uint32_t> material;   // Material of each chart
+};
+
+// Outputs of all meshes in flat arrays. The vertices of mesh i are `mapping[vertexOffsets[i]:vertexOffsets[i + 1]]`
+// (and the same rows of `uvs`) and its faces are `indices[faceOffsets[i]:faceOffsets[i + 1]]`, relative to its first vertex.
+struct Meshes
+{
+    pybind11::array_t<std::uint32_t> mapping;       // Original vertex of each output vertex
+    pybind11::array_t<std::uint32_t> indices;       // Faces (relative to the vertices of their mesh)
+    pybind11::array_t<float>         uvs;           // Normalized texture coordinates
+    pybind11::array_t<std::uint32_t> vertexOffsets; // Offsets into `mapping` and `uvs` (number of meshes + 1)
+    pybind11::array_t<std::uint32_t> faceOffsets;   // Offsets into `indices` (number of meshes + 1)
+};
+
+// Input arrays of a mesh, referenced by xatlas without copying where their dtype and layout allow it
+struct MeshInput
+{
+    MeshInput(pybind11::object const&                positions,
+              pybind11::object const&                indices,
+              std::optional<pybind11::object> const& normals = std::nullopt,
+              std::optional<pybind11::object> const& uvs     = std::nullopt);
+
+    xatlas::MeshDecl meshDecl() const;
+
+    // Hashes the values of the arrays (for caching)
+    void hash(Hasher& hasher) const;
+
+    // Whether any of the arrays had to be copied or converted
+    bool copied() const;
+
+    VertexBuffer                positions;
+    IndexBuffer                 indices;
+    std::optional<VertexBuffer> normals;
+    std::optional<VertexBuffer> uvs;
+};
+
 class Atlas
 {
 public:
-    Atlas();
+    // With `poolAllocator`, small allocations of xatlas are served from a pool owned by the atlas.
+    // Operations that allocate more than `memoryBudget` bytes are cancelled at the next progress update and raise
+    // `MemoryBudgetError`; allocations themselves are never refused.
+    explicit Atlas(bool poolAllocator = false, std::optional<std::size_t> memoryBudget = std::nullopt);
 
     virtual ~Atlas();
 
-    void addMesh(ContiguousArray<float> const&         positions,
-                 ContiguousArray<std::uint32_t> const& indices,
-                 std::optional<ContiguousArray<float>> normals = std::nullopt,
-                 std::optional<ContiguousArray<float>> uvs     = std::nullopt);
+    void addMesh(pybind11::object const&           positions,
+                 pybind11::object const&           indices,
+                 std::optional<pybind11::object>   normals          = std::nullopt,
+                 std::optional<pybind11::object>   uvs              = std::nullopt,
+                 std::optional<pybind11::function> progressCallback = std::nullopt,
+                 std::optional<WeldOptions>        weld             = std::nullopt);
+
+    void addMeshFromFile(std::string const&                path,
+                         unsigned int                      numThreads       = 0,
+                         std::optional<pybind11::function> progressCallback = std::nullopt,
+                         std::optional<WeldOptions>        weld             = std::nullopt);
+
+    void addUvMesh(pybind11::object const&                  uvs,
+                   pybind11::object const&                  indices,
+                   std::optional<ContiguousArray<uint32_t>> faceMaterials    = std::nullopt,
+                   std::optional<pybind11::function>        progressCallback = std::nullopt);
+
+    // Adds the meshes of concatenated arrays in one call. The vertices of mesh i are `positions[vertexOffsets[i]:vertexOffsets[i + 1]]`
+    // and its faces `indices[faceOffsets[i]:faceOffsets[i + 1]]`, with indices relative to its first vertex.
+    void addMeshes(pybind11::object const&           positions,
+                   pybind11::object const&           indices,
+                   pybind11::object const&           vertexOffsets,
+                   pybind11::object const&           faceOffsets,
+                   std::optional<pybind11::object>   normals          = std::nullopt,
+                   std::optional<pybind11::object>   uvs              = std::nullopt,
+                   std::optional<pybind11::function> progressCallback = std::nullopt,
+                   std::optional<WeldOptions>        weld             = std::nullopt);
+
+    void addUvMeshes(pybind11::object const&                  uvs,
+                     pybind11::object const&                  indices,
+                     pybind11::object const&                  vertexOffsets,
+                     pybind11::object const&                  faceOffsets,
+                     std::optional<ContiguousArray<uint32_t>> faceMaterials    = std::nullopt,
+                     std::optional<pybind11::function>        progressCallback = std::nullopt);
+
+    // With a cache, the output is restored if the same meshes have been generated with the same options before.
+    // With a time budget (in seconds), the charts are packed in tiers of increasing quality until the budget is spent.
+    // xatlas runs on `numThreads` threads (0 uses `defaultThreadCount()`), at most on the default thread count at the
+    // creation of the atlas.
+    void generate(xatlas::ChartOptions const& chartOptions = xatlas::ChartOptions(), xatlas::PackOptions const& packOptions = xatlas::PackOptions(), bool verbose = false, std::optional<pybind11::function> progressCallback = std::nullopt, Cache* cache = nullptr, std::optional<double> timeBudget = std::nullopt, unsigned int numThreads = 0);
 
-    void addUvMesh(ContiguousArray<float> const&            uvs,
-                   ContiguousArray<std::uint32_t> const&    indices,
-                   std::optional<ContiguousArray<uint32_t>> faceMaterials = std::nullopt);
+    // Generates the atlas on a background thread and returns an `xatlas.Future` (resolved with None).
+    // The atlas cannot be used until the future is done.
+    pybind11::object generateAsync(xatlas::ChartOptions const& chartOptions = xatlas::ChartOptions(), xatlas::PackOptions const& packOptions = xatlas::PackOptions(), std::optional<pybind11::function> progressCallback = std::nullopt, Cache* cache = nullptr, std::optional<double> timeBudget = std::nullopt, unsigned int numThreads = 0);
 
-    void generate(xatlas::ChartOptions const& chartOptions = xatlas::ChartOptions(), xatlas::PackOptions const& packOptions = xatlas::PackOptions(), bool verbose = false);
+    void computeCharts(xatlas::ChartOptions const& chartOptions = xatlas::ChartOptions(), std::optional<pybind11::function> progressCallback = std::nullopt);
 
-    MeshResult getMesh(std::uint32_t index) const;
+    void packCharts(xatlas::PackOptions const& packOptions = xatlas::PackOptions(), bool verbose = false, std::optional<pybind11::function> progressCallback = std::nullopt, std::optional<double> timeBudget = std::nullopt);
+
+    // Packs the charts of the generated atlas `other` into the free space of this atlas without moving the existing charts.
+    // The output is composed of both atlases afterwards and cannot be regenerated (but packed incrementally again).
+    void packIncremental(Atlas const& other, IncrementalOptions const& options, unsigned int numThreads = 0);
+
+    // Outputs of a mesh as `(mapping, indices, uvs)`, or encoded in the given format (see format.hpp)
+    pybind11::object getMesh(std::uint32_t index, std::optional<OutputFormat> const& format = std::nullopt) const;
+
+    // Outputs of all meshes at once, filled in parallel
+    Meshes getMeshes() const;
 
     VertexAssignment getMeshVertexAssignment(std::uint32_t meshIndex) const;
 
@@ -79,12 +188,122 @@ public:
 
     Chart getMeshChart(std::uint32_t meshIndex, std::uint32_t chartIndex) const;
 
+    Charts getCharts(std::optional<std::uint32_t> meshIndex = std::nullopt) const;
+
     float getUtilization(std::uint32_t index) const;
 
-    pybind11::array_t<std::uint8_t> getChartImage(std::uint32_t index) const;
+    // Debug image of one atlas, or of all atlases as (atlas count x height x width x 3) without an index
+    pybind11::array_t<std::uint8_t> getChartImage(std::optional<std::uint32_t> index = std::nullopt) const;
+
+    // Read-only view of the raw image of all atlases (chart index and xatlas::kImage* bits of each texel) without copying.
+    // The atlas cannot be modified while views are referenced.
+    pybind11::array_t<std::uint32_t> getChartIdImage() const;
+
+    // Rasterizes the meshes into the atlas and returns the mesh and triangle index, the barycentric coordinates and
+    // optionally the interpolated positions and normals (one array per mesh) of each texel
+    pybind11::dict bakeGeometry(std::optional<std::vector<pybind11::object>> positions = std::nullopt, std::optional<std::vector<pybind11::object>> normals = std::nullopt, bool conservative = true, unsigned int numThreads = 0) const;
+
+    // Resamples a texture (or one texture per mesh) that is mapped by the original UVs of the meshes into the atlas
+    pybind11::array remapTexture(pybind11::object const& textures, std::vector<pybind11::object> const& uvs, std::uint32_t dilation = 4, unsigned int numThreads = 0) const;
+
+    // Timings of the operations and xatlas stages, counters and memory statistics
+    pybind11::dict getStats() const;
+
+    void writeTrace(std::string const& path) const;
+
+    // Writes the output (meshes, charts, utilization and optionally the chart image) to a file.
+    // The inputs and the xatlas state are not stored, so a loaded atlas is read-only.
+    void save(std::string const& path, bool includeImage = true) const;
+
+    // With `map`, the arrays of the atlas reference the memory mapped file instead of a copy
+    static std::unique_ptr<Atlas> load(std::string const& path, bool map = true);
+
+    pybind11::bytes toBytes(bool includeImage = true) const;
+
+    static std::unique_ptr<Atlas> fromBytes(pybind11::bytes const& bytes);
+
+    // Output of xatlas or of the restored atlas
+    xatlas::Atlas const& output() const;
+
+    // Original vertex indices of the welded meshes (null if the output already refers to them)
+    VertexRemaps const* vertexRemaps() const;
+
+    // Copies the output of a (valid) mesh of an atlas into new arrays, mapping the vertex references through `vertexRemap` (if any)
+    static MeshResult meshToArrays(xatlas::Atlas const& atlas, std::uint32_t index, std::vector<std::uint32_t> const* vertexRemap = nullptr);
 
     static void bind(pybind11::module& m);
 
 private:
-    xatlas::Atlas* m_atlas;
+    explicit Atlas(std::unique_ptr<RestoredAtlas> restored);
+
+    // Marks the atlas as busy while a native operation runs without the GIL.
+    // Concurrent calls from other Python threads fail instead of racing on the xatlas state.
+    // The allocations of the calling thread are attributed to the atlas meanwhile and xatlas runs on the default number of threads.
+    class BusyScope
+    {
+    public:
+        // Without `write`, read-only (restored) atlases can be used as well
+        explicit BusyScope(Atlas const& atlas, bool write = true);
+        ~BusyScope();
+
+    private:
+        Atlas const& m_atlas;
+        MemoryScope  m_memory;
+    };
+
+    // Registers a reader of the output while it is read without the GIL (the atlas may have exported images).
+    // Readers do not exclude each other, but fail while the atlas is busy and keep `BusyScope` from starting.
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(Atlas const& atlas);
+        ~ReadScope();
+
+    private:
+        Atlas const& m_atlas;
+    };
+
+    // Result of packing in tiers under a time budget
+    struct PackingReport
+    {
+        std::string   tier;           // Tier of the returned packing
+        std::uint32_t tiersCompleted; // Number of tiers that finished before the deadline
+        double        seconds;        // Time spent packing
+        bool          deadlineReached;
+    };
+
+    // Generates the atlas or restores it from the cache (without the GIL, while busy)
+    void generateNative(xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions, Cache* cache, std::uint64_t key, std::optional<double> timeBudget, unsigned int numThreads);
+
+    // Packs the charts with `packOptions` (without the GIL, while busy), or in tiers under a time budget
+    void packNative(xatlas::PackOptions const& packOptions, std::optional<double> timeBudget);
+
+    void checkWritable() const;
+
+    void checkNotExported() const;
+
+    void checkNotBusy() const;
+
+    // Marks the atlas as busy, or throws if it is busy or read by another thread
+    void acquireBusy() const;
+
+    // Output for the Python properties, which must not read it while a job replaces it
+    xatlas::Atlas const& checkedOutput() const;
+
+    void printStatistics() const;
+
+    xatlas::Atlas*                   m_atlas;
+    mutable std::atomic<bool>        m_busy;
+    mutable std::atomic<std::size_t> m_readers;        // Number of live `ReadScope`s
+    mutable std::atomic<std::size_t> m_imageExports;   // Number of referenced `chart_id_image` views
+    bool                             m_chartsComputed;  // Charts are up to date with the added meshes and can be (re)packed
+    bool                             m_lastInputCopied; // The inputs of the last added mesh had to be copied or converted
+    bool                             m_readOnly;        // The atlas was loaded from serialized data
+    Hasher                           m_inputHash;       // Hash of all added meshes
+    VertexRemaps                     m_vertexRemaps;    // Original vertices of the welded meshes
+    mutable Timeline                 m_timeline;
+    std::unique_ptr<ProgressMonitor> m_progress;
+    MemoryTracker::Pointer           m_memory;
+    std::unique_ptr<RestoredAtlas>   m_restored; // Output loaded from serialized data or from a cache (instead of xatlas)
+    std::optional<PackingReport>     m_packingReport; // Of the last packing with a time budget
 };
\ No newline at end of file
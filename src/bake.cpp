@@ -0,0 +1,588 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bake.hpp"
+#include "threading.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace
+{
+
+constexpr std::uint32_t const tileSize = 64;
+
+struct Vec2
+{
+    float x;
+    float y;
+};
+
+inline float cross(Vec2 a, Vec2 b, Vec2 c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+inline float dot(Vec2 a, Vec2 b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+inline Vec2 sub(Vec2 a, Vec2 b)
+{
+    return {a.x - b.x, a.y - b.y};
+}
+
+// Barycentric coordinates of the point of triangle (a, b, c) closest to p (Ericson, Real-Time Collision Detection, 5.1.5)
+std::array<float, 3> closestPoint(Vec2 p, Vec2 a, Vec2 b, Vec2 c)
+{
+    Vec2 const ab = sub(b, a);
+    Vec2 const ac = sub(c, a);
+    Vec2 const ap = sub(p, a);
+
+    float const d1 = dot(ab, ap);
+    float const d2 = dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        return {1.0f, 0.0f, 0.0f};
+    }
+
+    Vec2 const  bp = sub(p, b);
+    float const d3 = dot(ab, bp);
+    float const d4 = dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        return {0.0f, 1.0f, 0.0f};
+    }
+
+    float const vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        float const v = d1 / (d1 - d3);
+        return {1.0f - v, v, 0.0f};
+    }
+
+    Vec2 const  cp = sub(p, c);
+    float const d5 = dot(ab, cp);
+    float const d6 = dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        return {0.0f, 0.0f, 1.0f};
+    }
+
+    float const vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        float const w = d2 / (d2 - d6);
+        return {1.0f - w, 0.0f, w};
+    }
+
+    float const va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        float const w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return {0.0f, 1.0f - w, w};
+    }
+
+    float const denominator = 1.0f / (va + vb + vc);
+    float const v           = vb * denominator;
+    float const w           = vc * denominator;
+    return {1.0f - v - w, v, w};
+}
+
+struct TriangleRef
+{
+    std::uint32_t mesh;
+    std::uint32_t face;
+};
+
+// Best triangle found for a texel so far. Ties are broken by the lower mesh and triangle index,
+// so the result does not depend on the order of the triangles.
+struct Sample
+{
+    float                distance = std::numeric_limits<float>::infinity();
+    std::uint32_t        mesh     = 0;
+    std::uint32_t        face     = 0;
+    std::array<float, 3> barycentrics{};
+
+    bool better(float otherDistance, std::uint32_t otherMesh, std::uint32_t otherFace) const
+    {
+        if (otherDistance != distance)
+        {
+            return otherDistance < distance;
+        }
+        return otherMesh < mesh || (otherMesh == mesh && otherFace < face);
+    }
+};
+
+inline float const* row(float const* data, std::uint32_t stride, std::uint32_t index)
+{
+    return reinterpret_cast<float const*>(reinterpret_cast<char const*>(data) + static_cast<std::size_t>(stride) * index);
+}
+
+template<typename T>
+inline float toFloat(T value)
+{
+    return static_cast<float>(value);
+}
+
+template<typename T>
+inline T fromFloat(float value)
+{
+    if constexpr (std::is_same_v<T, std::uint8_t>)
+    {
+        return static_cast<std::uint8_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+    }
+    else
+    {
+        return value;
+    }
+}
+
+// Bilinear lookup with clamping to the edges, `x` and `y` in texels
+template<typename T>
+void sampleBilinear(TextureView const& texture, float x, float y, float* result)
+{
+    T const*    data  = static_cast<T const*>(texture.data);
+    float const fx    = std::floor(x);
+    float const fy    = std::floor(y);
+    float const tx    = x - fx;
+    float const ty    = y - fy;
+    auto const  clamp = [](float value, std::uint32_t size) {
+        return static_cast<std::size_t>(std::min(std::max(value, 0.0f), float(size - 1)));
+    };
+
+    std::size_t const x0 = clamp(fx, texture.width);
+    std::size_t const x1 = clamp(fx + 1.0f, texture.width);
+    std::size_t const y0 = clamp(fy, texture.height);
+    std::size_t const y1 = clamp(fy + 1.0f, texture.height);
+
+    for (std::uint32_t c = 0; c < texture.channels; ++c)
+    {
+        float const v00 = toFloat(data[(y0 * texture.width + x0) * texture.channels + c]);
+        float const v10 = toFloat(data[(y0 * texture.width + x1) * texture.channels + c]);
+        float const v01 = toFloat(data[(y1 * texture.width + x0) * texture.channels + c]);
+        float const v11 = toFloat(data[(y1 * texture.width + x1) * texture.channels + c]);
+        result[c]       = (v00 * (1.0f - tx) + v10 * tx) * (1.0f - ty) + (v01 * (1.0f - tx) + v11 * tx) * ty;
+    }
+}
+
+template<typename T>
+void remapTexels(xatlas::Atlas const& atlas, std::vector<BakeMesh> const& meshes, std::vector<TextureView> const& textures, T* output, std::uint32_t dilation, unsigned int threadCount)
+{
+    std::size_t const width    = atlas.width;
+    std::size_t const height   = atlas.height;
+    std::size_t const rows     = height * atlas.atlasCount;
+    std::size_t const texels   = rows * width;
+    std::size_t const channels = textures.empty() ? 0 : textures[0].channels;
+
+    std::vector<std::int32_t> meshIndex(texels);
+    std::vector<std::int32_t> triangleIndex(texels);
+    std::vector<float>        barycentrics(texels * 3);
+
+    BakeOutput baked;
+    baked.meshIndex     = meshIndex.data();
+    baked.triangleIndex = triangleIndex.data();
+    baked.barycentrics  = barycentrics.data();
+    bakeGeometry(atlas, meshes, baked, true, threadCount);
+
+    // Sample the sources at the interpolated UVs of the covered texels
+    std::vector<std::uint8_t> covered(texels);
+    parallelFor(rows, 16, [&](std::size_t begin, std::size_t end) {
+        std::vector<float> sample(channels);
+        for (std::size_t texel = begin * width; texel < end * width; ++texel)
+        {
+            T* target      = output + texel * channels;
+            covered[texel] = meshIndex[texel] >= 0;
+            if (!covered[texel])
+            {
+                std::fill_n(target, channels, T(0));
+                continue;
+            }
+
+            auto const&          mesh    = atlas.meshes[meshIndex[texel]];
+            auto const&          input   = meshes[meshIndex[texel]];
+            TextureView const&   texture = textures[meshIndex[texel]];
+            std::uint32_t const* corners = mesh.indexArray + static_cast<std::size_t>(triangleIndex[texel]) * 3;
+
+            float u = 0.0f;
+            float v = 0.0f;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                std::uint32_t const xref   = mesh.vertexArray[corners[corner]].xref;
+                float const*        uv     = row(input.uvs, input.uvStride, input.vertexRemap ? (*input.vertexRemap)[xref] : xref);
+                float const         weight = barycentrics[texel * 3 + corner];
+                u += weight * uv[0];
+                v += weight * uv[1];
+            }
+
+            sampleBilinear<T>(texture, u * float(texture.width) - 0.5f, v * float(texture.height) - 0.5f, sample.data());
+            for (std::size_t c = 0; c < channels; ++c)
+            {
+                target[c] = fromFloat<T>(sample[c]);
+            }
+        }
+    }, threadCount);
+
+    // Each pass fills the empty texels next to covered ones with the average of their covered neighbors.
+    // Only texels that were covered before the pass are read and only empty ones are written, so rows can be processed in parallel.
+    std::vector<std::uint8_t> next(covered);
+    for (std::uint32_t pass = 0; pass < dilation; ++pass)
+    {
+        std::atomic<bool> changed{false};
+        parallelFor(rows, 16, [&](std::size_t begin, std::size_t end) {
+            std::vector<float> sum(channels);
+            bool               filled = false;
+            for (std::size_t r = begin; r < end; ++r)
+            {
+                std::size_t const y         = r % height;
+                std::size_t const atlasBase = (r - y) * width;
+                for (std::size_t x = 0; x < width; ++x)
+                {
+                    std::size_t const texel = r * width + x;
+                    if (covered[texel])
+                    {
+                        continue;
+                    }
+
+                    std::fill(sum.begin(), sum.end(), 0.0f);
+                    std::uint32_t count = 0;
+                    for (std::ptrdiff_t dy = -1; dy <= 1; ++dy)
+                    {
+                        for (std::ptrdiff_t dx = -1; dx <= 1; ++dx)
+                        {
+                            std::ptrdiff_t const nx = std::ptrdiff_t(x) + dx;
+                            std::ptrdiff_t const ny = std::ptrdiff_t(y) + dy;
+                            if (nx < 0 || ny < 0 || nx >= std::ptrdiff_t(width) || ny >= std::ptrdiff_t(height))
+                            {
+                                continue;
+                            }
+
+                            std::size_t const neighbor = atlasBase + std::size_t(ny) * width + std::size_t(nx);
+                            if (covered[neighbor])
+                            {
+                                for (std::size_t c = 0; c < channels; ++c)
+                                {
+                                    sum[c] += toFloat(output[neighbor * channels + c]);
+                                }
+                                ++count;
+                            }
+                        }
+                    }
+
+                    if (count > 0)
+                    {
+                        for (std::size_t c = 0; c < channels; ++c)
+                        {
+                            output[texel * channels + c] = fromFloat<T>(sum[c] / float(count));
+                        }
+                        next[texel] = 1;
+                        filled      = true;
+                    }
+                }
+            }
+
+            if (filled)
+            {
+                changed = true;
+            }
+        }, threadCount);
+
+        if (!changed)
+        {
+            break;
+        }
+        covered = next;
+    }
+}
+
+} // namespace
+
+void bakeGeometry(xatlas::Atlas const& atlas, std::vector<BakeMesh> const& meshes, BakeOutput const& output, bool conservative, unsigned int threadCount)
+{
+    std::size_t const width     = atlas.width;
+    std::size_t const height    = atlas.height;
+    std::size_t const tilesX    = (width + tileSize - 1) / tileSize;
+    std::size_t const tilesY    = (height + tileSize - 1) / tileSize;
+    std::size_t const tileCount = tilesX * tilesY * atlas.atlasCount;
+    float const       margin    = conservative ? 0.5f : 0.0f; // Half a texel
+
+    // Vertices must refer to existing attribute rows
+    for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+    {
+        auto const& mesh  = atlas.meshes[m];
+        auto const& input = meshes[m];
+        if (!input.positions && !input.normals && !input.uvs)
+        {
+            continue;
+        }
+
+        for (std::uint32_t v = 0; v < mesh.vertexCount; ++v)
+        {
+            std::uint32_t const xref = mesh.vertexArray[v].xref;
+            if ((input.vertexRemap ? (*input.vertexRemap)[xref] : xref) >= input.vertexCount)
+            {
+                throw std::invalid_argument("The attributes of mesh " + std::to_string(m) + " have fewer rows than the mesh has vertices.");
+            }
+        }
+    }
+
+    // Sort the triangles into the tiles they may cover
+    auto const tileRange = [&](xatlas::Mesh const& mesh, std::uint32_t face, std::array<std::size_t, 5>& range) {
+        xatlas::Vertex const& v0 = mesh.vertexArray[mesh.indexArray[face * 3 + 0]];
+        xatlas::Vertex const& v1 = mesh.vertexArray[mesh.indexArray[face * 3 + 1]];
+        xatlas::Vertex const& v2 = mesh.vertexArray[mesh.indexArray[face * 3 + 2]];
+        if (v0.atlasIndex < 0 || static_cast<std::uint32_t>(v0.atlasIndex) >= atlas.atlasCount)
+        {
+            return false;
+        }
+
+        float const minX = std::min({v0.uv[0], v1.uv[0], v2.uv[0]}) - margin;
+        float const maxX = std::max({v0.uv[0], v1.uv[0], v2.uv[0]}) + margin;
+        float const minY = std::min({v0.uv[1], v1.uv[1], v2.uv[1]}) - margin;
+        float const maxY = std::max({v0.uv[1], v1.uv[1], v2.uv[1]}) + margin;
+        if (!(maxX >= 0.0f && maxY >= 0.0f && minX < float(width) && minY < float(height)))
+        {
+            return false;
+        }
+
+        range[0] = static_cast<std::size_t>(v0.atlasIndex);
+        range[1] = static_cast<std::size_t>(std::max(minX, 0.0f)) / tileSize;
+        range[2] = std::min(static_cast<std::size_t>(maxX), width - 1) / tileSize;
+        range[3] = static_cast<std::size_t>(std::max(minY, 0.0f)) / tileSize;
+        range[4] = std::min(static_cast<std::size_t>(maxY), height - 1) / tileSize;
+        return true;
+    };
+
+    // Count first, then fill the triangle lists of the tiles (CSR)
+    std::vector<std::size_t> tileOffsets(tileCount + 1, 0);
+    std::vector<TriangleRef> tileTriangles;
+    {
+        std::array<std::size_t, 5> range;
+        for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+        {
+            auto const& mesh = atlas.meshes[m];
+            for (std::uint32_t f = 0; f < mesh.indexCount / 3; ++f)
+            {
+                if (tileRange(mesh, f, range))
+                {
+                    for (std::size_t ty = range[3]; ty <= range[4]; ++ty)
+                    {
+                        for (std::size_t tx = range[1]; tx <= range[2]; ++tx)
+                        {
+                            tileOffsets[(range[0] * tilesY + ty) * tilesX + tx + 1]++;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (std::size_t t = 0; t < tileCount; ++t)
+        {
+            tileOffsets[t + 1] += tileOffsets[t];
+        }
+
+        tileTriangles.resize(tileOffsets[tileCount]);
+        std::vector<std::size_t> next(tileOffsets.begin(), tileOffsets.end() - 1);
+        for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+        {
+            auto const& mesh = atlas.meshes[m];
+            for (std::uint32_t f = 0; f < mesh.indexCount / 3; ++f)
+            {
+                if (tileRange(mesh, f, range))
+                {
+                    for (std::size_t ty = range[3]; ty <= range[4]; ++ty)
+                    {
+                        for (std::size_t tx = range[1]; tx <= range[2]; ++tx)
+                        {
+                            tileTriangles[next[(range[0] * tilesY + ty) * tilesX + tx]++] = {m, f};
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    bool const bakePositions = output.positions != nullptr;
+    bool const bakeNormals   = output.normals != nullptr;
+
+    // Rasterize the tiles independently, each texel is written by exactly one tile
+    parallelFor(tileCount, 1, [&](std::size_t begin, std::size_t end) {
+        std::vector<Sample> samples(tileSize * tileSize);
+        for (std::size_t tile = begin; tile < end; ++tile)
+        {
+            std::size_t const atlasIndex = tile / (tilesX * tilesY);
+            std::size_t const x0         = (tile % tilesX) * tileSize;
+            std::size_t const y0         = (tile / tilesX % tilesY) * tileSize;
+            std::size_t const x1         = std::min<std::size_t>(x0 + tileSize, width);
+            std::size_t const y1         = std::min<std::size_t>(y0 + tileSize, height);
+
+            std::fill(samples.begin(), samples.end(), Sample());
+
+            for (std::size_t i = tileOffsets[tile]; i < tileOffsets[tile + 1]; ++i)
+            {
+                TriangleRef const    triangle = tileTriangles[i];
+                auto const&          mesh     = atlas.meshes[triangle.mesh];
+                std::uint32_t const* corners  = mesh.indexArray + triangle.face * 3;
+
+                Vec2 const a{mesh.vertexArray[corners[0]].uv[0], mesh.vertexArray[corners[0]].uv[1]};
+                Vec2 const b{mesh.vertexArray[corners[1]].uv[0], mesh.vertexArray[corners[1]].uv[1]};
+                Vec2 const c{mesh.vertexArray[corners[2]].uv[0], mesh.vertexArray[corners[2]].uv[1]};
+
+                float const area = cross(a, b, c);
+                if (!(std::fabs(area) > 1e-12f))
+                {
+                    continue;
+                }
+                float const orientation = area > 0.0f ? 1.0f : -1.0f;
+
+                // Half extent of a texel projected onto the normal of each edge
+                std::array<float, 3> const slack{
+                    margin * (std::fabs(c.x - b.x) + std::fabs(c.y - b.y)),
+                    margin * (std::fabs(a.x - c.x) + std::fabs(a.y - c.y)),
+                    margin * (std::fabs(b.x - a.x) + std::fabs(b.y - a.y))};
+
+                float const minX = std::min({a.x, b.x, c.x}) - margin;
+                float const maxX = std::max({a.x, b.x, c.x}) + margin;
+                float const minY = std::min({a.y, b.y, c.y}) - margin;
+                float const maxY = std::max({a.y, b.y, c.y}) + margin;
+
+                std::size_t const beginX = std::max<std::size_t>(x0, static_cast<std::size_t>(std::max(0.0f, std::floor(minX))));
+                std::size_t const endX   = std::min<std::size_t>(x1, static_cast<std::size_t>(std::max(0.0f, std::ceil(maxX))));
+                std::size_t const beginY = std::max<std::size_t>(y0, static_cast<std::size_t>(std::max(0.0f, std::floor(minY))));
+                std::size_t const endY   = std::min<std::size_t>(y1, static_cast<std::size_t>(std::max(0.0f, std::ceil(maxY))));
+
+                for (std::size_t y = beginY; y < endY; ++y)
+                {
+                    for (std::size_t x = beginX; x < endX; ++x)
+                    {
+                        Vec2 const  p{float(x) + 0.5f, float(y) + 0.5f};
+                        float const w0 = cross(b, c, p) * orientation;
+                        float const w1 = cross(c, a, p) * orientation;
+                        float const w2 = cross(a, b, p) * orientation;
+
+                        Sample& sample = samples[(y - y0) * tileSize + (x - x0)];
+                        if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+                        {
+                            if (sample.better(0.0f, triangle.mesh, triangle.face))
+                            {
+                                float const scale = orientation / area;
+                                sample            = {0.0f, triangle.mesh, triangle.face, {w0 * scale, w1 * scale, w2 * scale}};
+                            }
+                        }
+                        else if (conservative && w0 + slack[0] >= 0.0f && w1 + slack[1] >= 0.0f && w2 + slack[2] >= 0.0f)
+                        {
+                            std::array<float, 3> const barycentrics = closestPoint(p, a, b, c);
+
+                            float const dx       = barycentrics[0] * a.x + barycentrics[1] * b.x + barycentrics[2] * c.x - p.x;
+                            float const dy       = barycentrics[0] * a.y + barycentrics[1] * b.y + barycentrics[2] * c.y - p.y;
+                            float const distance = std::sqrt(dx * dx + dy * dy);
+                            if (sample.better(distance, triangle.mesh, triangle.face))
+                            {
+                                sample = {distance, triangle.mesh, triangle.face, barycentrics};
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Write the samples (also the empty ones, the outputs are not initialized)
+            for (std::size_t y = y0; y < y1; ++y)
+            {
+                for (std::size_t x = x0; x < x1; ++x)
+                {
+                    Sample const&     sample = samples[(y - y0) * tileSize + (x - x0)];
+                    std::size_t const texel  = (atlasIndex * height + y) * width + x;
+                    bool const        hit    = sample.distance != std::numeric_limits<float>::infinity();
+
+                    output.meshIndex[texel]     = hit ? static_cast<std::int32_t>(sample.mesh) : -1;
+                    output.triangleIndex[texel] = hit ? static_cast<std::int32_t>(sample.face) : -1;
+                    std::copy_n(hit ? sample.barycentrics.data() : std::array<float, 3>{}.data(), 3, output.barycentrics + texel * 3);
+
+                    std::array<float, 3> position{};
+                    std::array<float, 3> normal{};
+                    if (hit)
+                    {
+                        auto const&          mesh    = atlas.meshes[sample.mesh];
+                        auto const&          input   = meshes[sample.mesh];
+                        std::uint32_t const* corners = mesh.indexArray + sample.face * 3;
+                        for (int corner = 0; corner < 3; ++corner)
+                        {
+                            std::uint32_t const xref   = mesh.vertexArray[corners[corner]].xref;
+                            std::uint32_t const vertex = input.vertexRemap ? (*input.vertexRemap)[xref] : xref;
+                            float const         weight = sample.barycentrics[corner];
+                            for (int k = 0; k < 3; ++k)
+                            {
+                                if (bakePositions)
+                                {
+                                    position[k] += weight * row(input.positions, input.positionStride, vertex)[k];
+                                }
+                                if (bakeNormals)
+                                {
+                                    normal[k] += weight * row(input.normals, input.normalStride, vertex)[k];
+                                }
+                            }
+                        }
+
+                        float const length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                        if (length > 0.0f)
+                        {
+                            for (float& value : normal)
+                            {
+                                value /= length;
+                            }
+                        }
+                    }
+
+                    if (bakePositions)
+                    {
+                        std::copy_n(position.data(), 3, output.positions + texel * 3);
+                    }
+                    if (bakeNormals)
+                    {
+                        std::copy_n(normal.data(), 3, output.normals + texel * 3);
+                    }
+                }
+            }
+        }
+    }, threadCount);
+}
+
+void remapTexture(xatlas::Atlas const& atlas, std::vector<BakeMesh> const& meshes, std::vector<TextureView> const& textures, bool floatTexels, void* output, std::uint32_t dilation, unsigned int threadCount)
+{
+    if (floatTexels)
+    {
+        remapTexels(atlas, meshes, textures, static_cast<float*>(output), dilation, threadCount);
+    }
+    else
+    {
+        remapTexels(atlas, meshes, textures, static_cast<std::uint8_t*>(output), dilation, threadCount);
+    }
+}
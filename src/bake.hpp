@@ -0,0 +1,76 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <xatlas.h>
+
+#include <cstdint>
+#include <vector>
+
+// Per-vertex attributes of the input of one mesh of an atlas, addressed by the original vertex index
+struct BakeMesh
+{
+    std::vector<std::uint32_t> const* vertexRemap    = nullptr; // Maps `xref` to the original vertex (if not null)
+    float const*                      positions      = nullptr; // 3 floats per vertex (optional)
+    std::uint32_t                     positionStride = 0;       // In bytes
+    float const*                      normals        = nullptr; // 3 floats per vertex (optional)
+    std::uint32_t                     normalStride   = 0;       // In bytes
+    float const*                      uvs            = nullptr; // 2 floats per vertex (optional)
+    std::uint32_t                     uvStride       = 0;       // In bytes
+    std::uint32_t                     vertexCount    = 0;       // Number of rows of the attributes
+};
+
+// Outputs of `bakeGeometry` with (atlas count x height x width) texels each.
+// Texels that are not covered by a triangle have the mesh and triangle index -1 and zero attributes.
+struct BakeOutput
+{
+    std::int32_t* meshIndex     = nullptr;
+    std::int32_t* triangleIndex = nullptr;
+    float*        barycentrics  = nullptr; // 3 floats per texel, w.r.t. the corners of the output triangle
+    float*        positions     = nullptr; // 3 floats per texel (optional, requires the positions of all meshes)
+    float*        normals       = nullptr; // 3 floats per texel (optional, requires the normals of all meshes), normalized
+};
+
+// Rasterizes the triangles of all meshes of a generated atlas in texel space, in parallel tiles.
+// A texel is covered by the triangle that contains its center. With `conservative`, texels that are only
+// partially overlapped at the chart borders are covered as well, by the closest point of the nearest triangle.
+// Throws std::invalid_argument if the attributes have fewer rows than the referenced vertices.
+void bakeGeometry(xatlas::Atlas const& atlas, std::vector<BakeMesh> const& meshes, BakeOutput const& output, bool conservative, unsigned int threadCount = 0);
+
+// Row-major (height x width x channels) source texture of `remapTexture`
+struct TextureView
+{
+    void const*   data     = nullptr;
+    std::uint32_t width    = 0;
+    std::uint32_t height   = 0;
+    std::uint32_t channels = 0;
+};
+
+// Resamples textures that are mapped by the `uvs` of the meshes into the layout of the atlas.
+// `textures` holds one texture per mesh (all with the same number of channels) and the texels are either
+// uint8 or float32 (`floatTexels`), for the textures and for the (atlas count x height x width x channels) output.
+// UVs are normalized with v pointing down the rows of the texture and are sampled bilinearly with clamping.
+// Texels outside the charts are dilated from their neighbors `dilation` times, the remaining texels are zero.
+void remapTexture(xatlas::Atlas const& atlas, std::vector<BakeMesh> const& meshes, std::vector<TextureView> const& textures, bool floatTexels, void* output, std::uint32_t dilation, unsigned int threadCount = 0);
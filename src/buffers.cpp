@@ -0,0 +1,224 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "buffers.hpp"
+#include "kernels.hpp"
+#include "threading.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace py = pybind11;
+
+namespace
+{
+
+// Rows converted per task
+constexpr size_t const rowsPerTask = 1 << 16;
+
+// Views any array-like object (e.g. a nested list) as numpy array, without copying numpy arrays
+py::array toArray(py::handle object)
+{
+    py::array array = py::array::ensure(object);
+    if (!array)
+    {
+        throw py::error_already_set();
+    }
+    return array;
+}
+
+template<typename T>
+bool hasType(py::array const& array)
+{
+    // Compares the dtype including its byte order
+    return py::isinstance<py::array_t<T>>(array);
+}
+
+template<typename Source>
+void convertVertexArray(py::array const& array, std::vector<float>& out)
+{
+    size_t const      count           = static_cast<size_t>(array.shape(0));
+    size_t const      components      = static_cast<size_t>(array.shape(1));
+    char const*       data            = static_cast<char const*>(array.data());
+    py::ssize_t const rowStride       = array.strides(0);
+    py::ssize_t const componentStride = array.strides(1);
+
+    out.resize(count * components);
+
+    py::gil_scoped_release release;
+    parallelFor(count, rowsPerTask, [&](size_t begin, size_t end) {
+        convertVertices<Source>(data + static_cast<py::ssize_t>(begin) * rowStride, rowStride, componentStride, end - begin, components, out.data() + begin * components);
+    });
+}
+
+template<typename Source>
+bool convertIndexArray(py::array const& array, std::vector<std::uint32_t>& out)
+{
+    size_t const      count           = static_cast<size_t>(array.shape(0));
+    size_t const      components      = static_cast<size_t>(array.shape(1));
+    char const*       data            = static_cast<char const*>(array.data());
+    py::ssize_t const rowStride       = array.strides(0);
+    py::ssize_t const componentStride = array.strides(1);
+
+    out.resize(count * components);
+
+    std::atomic<bool> valid(true);
+
+    py::gil_scoped_release release;
+    parallelFor(count, rowsPerTask, [&](size_t begin, size_t end) {
+        if (!convertIndices<Source>(data + static_cast<py::ssize_t>(begin) * rowStride, rowStride, componentStride, end - begin, components, out.data() + begin * components))
+        {
+            valid = false;
+        }
+    });
+
+    return valid;
+}
+
+} // namespace
+
+VertexBuffer::VertexBuffer(std::string const& name, py::handle object, py::ssize_t components, std::optional<py::ssize_t> count)
+    : m_array(toArray(object))
+    , m_data(nullptr)
+    , m_stride(static_cast<std::uint32_t>(sizeof(float) * components))
+    , m_count(0)
+    , m_copied(false)
+{
+    py::array const array = m_array;
+    checkShape(name, array, components, count);
+
+    if (static_cast<size_t>(array.shape(0)) > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::invalid_argument(name + " array has too many elements.");
+    }
+    m_count = static_cast<std::uint32_t>(array.shape(0));
+
+    // xatlas reads consecutive floats at a (positive) byte stride per vertex
+    py::ssize_t const floatSize = static_cast<py::ssize_t>(sizeof(float));
+    py::ssize_t const rowStride = array.shape(0) > 1 ? array.strides(0) : static_cast<py::ssize_t>(m_stride);
+    bool const        aligned   = reinterpret_cast<std::uintptr_t>(array.data()) % alignof(float) == 0;
+    if (hasType<float>(array) && aligned && array.strides(1) == floatSize && rowStride > 0 && rowStride % floatSize == 0 && rowStride <= static_cast<py::ssize_t>(std::numeric_limits<std::uint32_t>::max()))
+    {
+        m_data   = array.data();
+        m_stride = static_cast<std::uint32_t>(rowStride);
+        return;
+    }
+
+    m_copied = true;
+    if (hasType<float>(array))
+    {
+        convertVertexArray<float>(array, m_converted);
+    }
+    else if (hasType<double>(array))
+    {
+        convertVertexArray<double>(array, m_converted);
+    }
+    else
+    {
+        // Let numpy handle the remaining types (e.g. float16 or integers)
+        m_array = ContiguousArray<float>::ensure(array);
+        if (!m_array)
+        {
+            throw py::error_already_set();
+        }
+        m_data = m_array.data();
+        return;
+    }
+
+    m_data = m_converted.data();
+}
+
+IndexBuffer::IndexBuffer(std::string const& name, py::handle object, py::ssize_t components)
+    : m_array(toArray(object))
+    , m_data(nullptr)
+    , m_format(xatlas::IndexFormat::UInt32)
+    , m_rows(0)
+    , m_count(0)
+    , m_copied(false)
+{
+    py::array const array = m_array;
+    checkShape(name, array, components);
+
+    if (static_cast<size_t>(array.size()) > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::invalid_argument(name + " array has too many elements.");
+    }
+    m_rows  = static_cast<std::uint32_t>(array.shape(0));
+    m_count = static_cast<std::uint32_t>(array.size());
+
+    // Negative int32 indices become out of range uint32 indices, which xatlas rejects
+    bool const contiguous = (array.flags() & py::array::c_style) != 0;
+    if (contiguous && hasType<std::uint16_t>(array))
+    {
+        m_data   = array.data();
+        m_format = xatlas::IndexFormat::UInt16;
+        return;
+    }
+    if (contiguous && (hasType<std::uint32_t>(array) || hasType<std::int32_t>(array)))
+    {
+        m_data = array.data();
+        return;
+    }
+
+    m_copied = true;
+
+    bool valid = true;
+    if (hasType<std::int64_t>(array))
+        valid = convertIndexArray<std::int64_t>(array, m_converted);
+    else if (hasType<std::uint64_t>(array))
+        valid = convertIndexArray<std::uint64_t>(array, m_converted);
+    else if (hasType<std::int32_t>(array))
+        valid = convertIndexArray<std::int32_t>(array, m_converted);
+    else if (hasType<std::uint32_t>(array))
+        valid = convertIndexArray<std::uint32_t>(array, m_converted);
+    else if (hasType<std::int16_t>(array))
+        valid = convertIndexArray<std::int16_t>(array, m_converted);
+    else if (hasType<std::uint16_t>(array))
+        valid = convertIndexArray<std::uint16_t>(array, m_converted);
+    else if (hasType<std::int8_t>(array))
+        valid = convertIndexArray<std::int8_t>(array, m_converted);
+    else if (hasType<std::uint8_t>(array))
+        valid = convertIndexArray<std::uint8_t>(array, m_converted);
+    else
+    {
+        // Let numpy handle the remaining types (e.g. floating point indices)
+        m_array = ContiguousArray<std::uint32_t>::ensure(array);
+        if (!m_array)
+        {
+            throw py::error_already_set();
+        }
+        m_data = m_array.data();
+        return;
+    }
+
+    if (!valid)
+    {
+        throw std::invalid_argument(name + " array contains negative indices or indices that exceed the uint32 range.");
+    }
+
+    m_data = m_converted.data();
+}
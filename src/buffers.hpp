@@ -0,0 +1,88 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <xatlas.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Nx`components` float array that is passed to xatlas by pointer and stride.
+// float32 arrays with consecutive components (including slices of interleaved buffers) are referenced directly,
+// float64 and other strided arrays are converted, everything else is cast by numpy.
+class VertexBuffer
+{
+public:
+    VertexBuffer(std::string const& name, pybind11::handle array, pybind11::ssize_t components, std::optional<pybind11::ssize_t> count = std::nullopt);
+
+    // The data pointer refers to the converted data, which moves along with the buffer
+    VertexBuffer(VertexBuffer const&) = delete;
+    VertexBuffer(VertexBuffer&&)      = default;
+
+    void const*   data() const { return m_data; }
+    std::uint32_t stride() const { return m_stride; }
+    std::uint32_t count() const { return m_count; }
+    bool          copied() const { return m_copied; }
+
+private:
+    pybind11::array    m_array;     // Keeps the referenced data alive
+    std::vector<float> m_converted; // Converted data (if any)
+    void const*        m_data;
+    std::uint32_t      m_stride;
+    std::uint32_t      m_count;
+    bool               m_copied;
+};
+
+// Nx`components` index array that is passed to xatlas as uint16 or uint32 indices.
+// C-contiguous uint16, uint32 and int32 arrays are referenced directly, other integer types and layouts are converted.
+class IndexBuffer
+{
+public:
+    IndexBuffer(std::string const& name, pybind11::handle array, pybind11::ssize_t components = 3);
+
+    // The data pointer refers to the converted data, which moves along with the buffer
+    IndexBuffer(IndexBuffer const&) = delete;
+    IndexBuffer(IndexBuffer&&)      = default;
+
+    void const*         data() const { return m_data; }
+    xatlas::IndexFormat format() const { return m_format; }
+    std::uint32_t       rows() const { return m_rows; }
+    std::uint32_t       count() const { return m_count; }
+    bool                copied() const { return m_copied; }
+
+private:
+    pybind11::array            m_array;     // Keeps the referenced data alive
+    std::vector<std::uint32_t> m_converted; // Converted data (if any)
+    void const*                m_data;
+    xatlas::IndexFormat        m_format;
+    std::uint32_t              m_rows;
+    std::uint32_t              m_count;
+    bool                       m_copied;
+};
@@ -0,0 +1,332 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <direct.h>
+#include <sys/utime.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace py = pybind11;
+
+namespace
+{
+
+// Changes whenever the output of the same inputs and options may change
+constexpr std::uint32_t const cacheVersion = 1;
+
+constexpr char const* const extension = ".xatlas";
+
+struct Entry
+{
+    std::string   path;
+    std::uint64_t size;
+    std::time_t   modified;
+};
+
+bool isEntry(std::string const& name)
+{
+    std::size_t const length = std::char_traits<char>::length(extension);
+    return name.size() > length && name.compare(name.size() - length, length, extension) == 0;
+}
+
+// Name of a temporary file that no other thread or process writes at the same time
+std::string temporaryPath(std::string const& path)
+{
+    static std::atomic<std::uint64_t> counter{0};
+
+#ifdef _WIN32
+    unsigned long const process = GetCurrentProcessId();
+#else
+    long const process = static_cast<long>(getpid());
+#endif
+
+    return path + "." + std::to_string(process) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "." + std::to_string(counter++) + ".tmp";
+}
+
+std::vector<Entry> listEntries(std::string const& directory)
+{
+    std::vector<Entry> entries;
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE           find = FindFirstFileA((directory + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return entries;
+    }
+
+    do
+    {
+        std::string const name = data.cFileName;
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isEntry(name))
+        {
+            // FILETIME counts 100ns intervals since 1601, only the order matters
+            ULARGE_INTEGER modified;
+            modified.LowPart  = data.ftLastWriteTime.dwLowDateTime;
+            modified.HighPart = data.ftLastWriteTime.dwHighDateTime;
+
+            entries.push_back({directory + "/" + name, (static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow, static_cast<std::time_t>(modified.QuadPart / 10000000ULL)});
+        }
+    } while (FindNextFileA(find, &data));
+
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        return entries;
+    }
+
+    while (dirent* entry = readdir(dir))
+    {
+        std::string const name = entry->d_name;
+        if (!isEntry(name))
+        {
+            continue;
+        }
+
+        // Entries may be removed concurrently by other processes
+        std::string const path = directory + "/" + name;
+        struct stat       info;
+        if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+        {
+            entries.push_back({path, static_cast<std::uint64_t>(info.st_size), info.st_mtime});
+        }
+    }
+
+    closedir(dir);
+#endif
+
+    return entries;
+}
+
+void createDirectory(std::string const& directory)
+{
+#ifdef _WIN32
+    int const result = _mkdir(directory.c_str());
+#else
+    int const result = mkdir(directory.c_str(), 0755);
+#endif
+
+    struct stat info;
+    if (result != 0 && (stat(directory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR)))
+    {
+        throw std::invalid_argument("Cannot create cache directory " + directory);
+    }
+}
+
+// Marks an entry as recently used
+void touch(std::string const& path)
+{
+#ifdef _WIN32
+    _utime(path.c_str(), nullptr);
+#else
+    utime(path.c_str(), nullptr);
+#endif
+}
+
+} // namespace
+
+Cache::Cache(std::string directory, std::uint64_t maxBytes)
+    : m_directory(std::move(directory))
+    , m_maxBytes(maxBytes)
+    , m_hits(0)
+    , m_misses(0)
+{
+    createDirectory(m_directory);
+}
+
+std::uint64_t Cache::key(Hasher inputs, xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions)
+{
+    // Fields are hashed one by one, the structs contain padding. A custom parametrization
+    // function (`paramFunc`) cannot be set from Python and is not part of the key.
+    inputs.update(cacheVersion);
+
+    inputs.update(chartOptions.maxChartArea);
+    inputs.update(chartOptions.maxBoundaryLength);
+    inputs.update(chartOptions.normalDeviationWeight);
+    inputs.update(chartOptions.roundnessWeight);
+    inputs.update(chartOptions.straightnessWeight);
+    inputs.update(chartOptions.normalSeamWeight);
+    inputs.update(chartOptions.textureSeamWeight);
+    inputs.update(chartOptions.maxCost);
+    inputs.update(chartOptions.maxIterations);
+    inputs.update(chartOptions.useInputMeshUvs);
+    inputs.update(chartOptions.fixWinding);
+
+    inputs.update(packOptions.maxChartSize);
+    inputs.update(packOptions.padding);
+    inputs.update(packOptions.texelsPerUnit);
+    inputs.update(packOptions.resolution);
+    inputs.update(packOptions.bilinear);
+    inputs.update(packOptions.blockAlign);
+    inputs.update(packOptions.bruteForce);
+    inputs.update(packOptions.createImage);
+    inputs.update(packOptions.rotateChartsToAxis);
+    inputs.update(packOptions.rotateCharts);
+
+    return inputs.digest();
+}
+
+std::unique_ptr<RestoredAtlas> Cache::load(std::uint64_t key)
+{
+    std::string const path = this->path(key);
+
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    {
+        ++m_misses;
+        return nullptr;
+    }
+
+    std::unique_ptr<RestoredAtlas> restored;
+    try
+    {
+        // The entry is read into memory, so it can be evicted while the atlas is in use
+        restored = RestoredAtlas::fromFile(path, false);
+    }
+    catch (std::exception const&)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::remove(path.c_str());
+        ++m_misses;
+        return nullptr;
+    }
+
+    touch(path);
+    ++m_hits;
+    return restored;
+}
+
+void Cache::store(std::uint64_t key, xatlas::Atlas const& atlas, VertexRemaps const* remaps)
+{
+    std::string const path = this->path(key);
+
+    // Entries appear atomically for concurrent readers (also in other processes)
+    std::string const temporary = temporaryPath(path);
+    saveAtlas(atlas, true, temporary, remaps);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Windows does not replace existing files. An existing entry has the same content.
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+    }
+
+    evict();
+}
+
+std::uint64_t Cache::size() const
+{
+    std::uint64_t size = 0;
+    for (auto const& entry : listEntries(m_directory))
+    {
+        size += entry.size;
+    }
+
+    return size;
+}
+
+void Cache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto const& entry : listEntries(m_directory))
+    {
+        std::remove(entry.path.c_str());
+    }
+}
+
+std::string Cache::path(std::uint64_t key) const
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return m_directory + "/" + name + extension;
+}
+
+void Cache::evict()
+{
+    std::vector<Entry> entries = listEntries(m_directory);
+
+    std::uint64_t size = 0;
+    for (auto const& entry : entries)
+    {
+        size += entry.size;
+    }
+
+    if (size <= m_maxBytes)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) { return a.modified < b.modified; });
+    for (auto const& entry : entries)
+    {
+        if (size <= m_maxBytes)
+        {
+            break;
+        }
+
+        std::remove(entry.path.c_str());
+        size -= entry.size;
+    }
+}
+
+void Cache::bind(py::module& m)
+{
+    py::class_<Cache>(m, "Cache")
+        .def(py::init<std::string, std::uint64_t>(), py::arg("directory"), py::arg("max_bytes") = std::uint64_t(1) << 30)
+        .def("clear", &Cache::clear)
+        .def_property_readonly("directory", &Cache::directory)
+        .def_property_readonly("max_bytes", &Cache::maxBytes)
+        .def_property_readonly("size", &Cache::size)
+        .def_property_readonly("hits", &Cache::hits)
+        .def_property_readonly("misses", &Cache::misses);
+}
@@ -0,0 +1,79 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "hash.hpp"
+#include "serialization.hpp"
+
+#include <pybind11/pybind11.h>
+
+#include <xatlas.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Directory of generated atlases, addressed by a hash of their inputs and options.
+// Entries are stored in the serialization format and the least recently used ones
+// are evicted when the directory exceeds `maxBytes`. Several processes may share a directory.
+class Cache
+{
+public:
+    Cache(std::string directory, std::uint64_t maxBytes);
+
+    // Key of the atlas generated from the hashed inputs with the given options
+    static std::uint64_t key(Hasher inputs, xatlas::ChartOptions const& chartOptions, xatlas::PackOptions const& packOptions);
+
+    // Returns the stored atlas or null. Unreadable entries are removed and count as misses.
+    std::unique_ptr<RestoredAtlas> load(std::uint64_t key);
+
+    void store(std::uint64_t key, xatlas::Atlas const& atlas, VertexRemaps const* remaps = nullptr);
+
+    // Total size of the entries in bytes
+    std::uint64_t size() const;
+
+    void clear();
+
+    std::string const& directory() const { return m_directory; }
+    std::uint64_t      maxBytes() const { return m_maxBytes; }
+    std::uint64_t      hits() const { return m_hits; }
+    std::uint64_t      misses() const { return m_misses; }
+
+    static void bind(pybind11::module& m);
+
+private:
+    std::string path(std::uint64_t key) const;
+
+    // Removes the least recently used entries until the size is within the limit (requires the mutex)
+    void evict();
+
+    std::string                m_directory;
+    std::uint64_t              m_maxBytes;
+    std::atomic<std::uint64_t> m_hits;
+    std::atomic<std::uint64_t> m_misses;
+    std::mutex                 m_mutex;
+};
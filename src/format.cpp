@@ -0,0 +1,183 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "format.hpp"
+
+#include <pybind11/numpy.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace py = pybind11;
+
+void OutputFormat::validate() const
+{
+    if (indexType != "uint32" && indexType != "uint16" && indexType != "auto")
+    {
+        throw std::invalid_argument("Unknown index type '" + indexType + "'. Use 'uint32', 'uint16' or 'auto'.");
+    }
+
+    if (uvType != "float32" && uvType != "float16" && uvType != "unorm16")
+    {
+        throw std::invalid_argument("Unknown UV type '" + uvType + "'. Use 'float32', 'float16' or 'unorm16'.");
+    }
+
+    if (uvType == "unorm16" && !normalized)
+    {
+        throw std::invalid_argument("unorm16 UVs must be normalized.");
+    }
+}
+
+void OutputFormat::bind(pybind11::module& m)
+{
+    py::class_<OutputFormat>(m, "OutputFormat")
+        .def(py::init<>())
+        .def_readwrite("index_type", &OutputFormat::indexType, "'uint32', 'uint16' or 'auto' (uint16 if the mesh has fewer than 65536 vertices, so that 0xFFFF stays free for primitive restart).")
+        .def_readwrite("uv_type", &OutputFormat::uvType, "'float32', 'float16' or 'unorm16' (normalized UVs only).")
+        .def_readwrite("normalized", &OutputFormat::normalized, "Normalize the UVs by the atlas size. If false, they are in texels.")
+        .def_readwrite("interleaved", &OutputFormat::interleaved, "Return a structured vertex array with the fields 'uv' and 'mapping' instead of separate arrays.");
+}
+
+void extractVertices(xatlas::Atlas const&              atlas,
+                     std::uint32_t                     index,
+                     std::size_t                       begin,
+                     std::size_t                       end,
+                     std::vector<std::uint32_t> const* vertexRemap,
+                     bool                              normalized,
+                     char*                             mapping,
+                     std::ptrdiff_t                    mappingStride,
+                     char*                             uvs,
+                     std::ptrdiff_t                    uvStride,
+                     UvEncoding                        encoding)
+{
+    xatlas::Vertex const* vertices = atlas.meshes[index].vertexArray + begin;
+    std::size_t const     count    = end - begin;
+    float const           scaleU   = normalized ? 1.f / atlas.width : 1.f;
+    float const           scaleV   = normalized ? 1.f / atlas.height : 1.f;
+
+    bool const planar = encoding == UvEncoding::Float32 && mappingStride == std::ptrdiff_t(sizeof(std::uint32_t)) && uvStride == std::ptrdiff_t(2 * sizeof(float));
+    if (!planar)
+    {
+        encodeVertices(vertices, count, scaleU, scaleV, vertexRemap ? vertexRemap->data() : nullptr, mapping, mappingStride, uvs, uvStride, encoding);
+        return;
+    }
+
+    std::uint32_t* const mappingData = reinterpret_cast<std::uint32_t*>(mapping);
+    deinterleaveVertices(vertices, count, scaleU, scaleV, mappingData, reinterpret_cast<float*>(uvs));
+
+    // Refer to the vertices of the caller instead of the welded ones
+    if (vertexRemap)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            mappingData[i] = (*vertexRemap)[mappingData[i]];
+        }
+    }
+}
+
+py::tuple encodeMesh(xatlas::Atlas const& atlas, std::uint32_t index, std::vector<std::uint32_t> const* vertexRemap, OutputFormat const& format)
+{
+    format.validate();
+
+    auto const& mesh = atlas.meshes[index];
+
+    if (format.indexType == "uint16" && mesh.vertexCount > 65536)
+    {
+        throw std::invalid_argument("Mesh " + std::to_string(index) + " has " + std::to_string(mesh.vertexCount) + " vertices, which cannot be indexed with uint16. Use 'auto' or 'uint32'.");
+    }
+
+    bool const       shortIndices = format.indexType == "uint16" || (format.indexType == "auto" && mesh.vertexCount < 65536);
+    UvEncoding const encoding     = format.uvType == "float16" ? UvEncoding::Float16 : format.uvType == "unorm16" ? UvEncoding::UNorm16 : UvEncoding::Float32;
+    std::size_t const uvSize      = encoding == UvEncoding::Float32 ? 2 * sizeof(float) : 2 * sizeof(std::uint16_t);
+    py::dtype const   uvDtype     = py::dtype::from_args(py::str(format.uvType == "unorm16" ? "uint16" : format.uvType));
+
+    // Allocate the outputs once and fill them through raw pointers
+    std::size_t const faceCount = mesh.indexCount / 3;
+    py::array         indices   = shortIndices ? py::array(py::array_t<std::uint16_t>(py::array::ShapeContainer{faceCount, std::size_t(3)}))
+                                               : py::array(py::array_t<std::uint32_t>(py::array::ShapeContainer{faceCount, std::size_t(3)}));
+    py::array         vertices;
+    py::array         mapping;
+    py::array         uvs;
+
+    char*          mappingData;
+    char*          uvsData;
+    std::ptrdiff_t mappingStride = sizeof(std::uint32_t);
+    std::ptrdiff_t uvStride      = static_cast<std::ptrdiff_t>(uvSize);
+
+    if (format.interleaved)
+    {
+        // The texture coordinates come first, so that the mapping is aligned in all encodings
+        py::list names;
+        names.append("uv");
+        names.append("mapping");
+        py::list formats;
+        formats.append(py::make_tuple(uvDtype, py::make_tuple(2)));
+        formats.append(py::dtype::of<std::uint32_t>());
+        py::list offsets;
+        offsets.append(0);
+        offsets.append(uvSize);
+
+        std::size_t const itemSize = uvSize + sizeof(std::uint32_t);
+        vertices                   = py::array(py::dtype(names, formats, offsets, static_cast<py::ssize_t>(itemSize)), py::array::ShapeContainer{std::size_t(mesh.vertexCount)});
+
+        char* data    = static_cast<char*>(vertices.mutable_data());
+        uvsData       = data;
+        mappingData   = data + uvSize;
+        mappingStride = static_cast<std::ptrdiff_t>(itemSize);
+        uvStride      = static_cast<std::ptrdiff_t>(itemSize);
+    }
+    else
+    {
+        mapping     = py::array_t<std::uint32_t>(py::array::ShapeContainer{mesh.vertexCount});
+        uvs         = py::array(uvDtype, py::array::ShapeContainer{std::size_t(mesh.vertexCount), std::size_t(2)});
+        mappingData = static_cast<char*>(mapping.mutable_data());
+        uvsData     = static_cast<char*>(uvs.mutable_data());
+    }
+
+    void* indicesData = indices.mutable_data();
+
+    {
+        py::gil_scoped_release release;
+
+        if (shortIndices)
+        {
+            narrowIndices(mesh.indexArray, faceCount * 3, static_cast<std::uint16_t*>(indicesData));
+        }
+        else
+        {
+            std::copy_n(mesh.indexArray, faceCount * 3, static_cast<std::uint32_t*>(indicesData));
+        }
+
+        extractVertices(atlas, index, 0, mesh.vertexCount, vertexRemap, format.normalized, mappingData, mappingStride, uvsData, uvStride, encoding);
+    }
+
+    if (format.interleaved)
+    {
+        return py::make_tuple(vertices, indices);
+    }
+
+    return py::make_tuple(mapping, indices, uvs);
+}
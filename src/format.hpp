@@ -0,0 +1,73 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "kernels.hpp"
+
+#include <pybind11/pybind11.h>
+
+#include <xatlas.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Encoding of the outputs of `get_mesh` and `parametrize`, e.g. to upload them to the GPU without another pass
+struct OutputFormat
+{
+    std::string indexType   = "uint32";  // "uint32", "uint16" or "auto" (uint16 if the mesh has fewer than 65536 vertices)
+    std::string uvType      = "float32"; // "float32", "float16" or "unorm16"
+    bool        normalized  = true;      // Divide the texture coordinates by the atlas size (otherwise they are in texels)
+    bool        interleaved = false;     // Return one structured array with the fields `uv` and `mapping` per vertex
+
+    // Throws std::invalid_argument for unknown types and combinations that cannot be encoded
+    void validate() const;
+
+    static void bind(pybind11::module& m);
+};
+
+// Writes the mapping and the texture coordinates of the vertices [begin, end) of a mesh at the given byte strides,
+// normalized by the atlas size if `normalized`. The mapping is looked up in `vertexRemap` if it is not null.
+// Planar float32 outputs take the vectorized path of `deinterleaveVertices`.
+void extractVertices(xatlas::Atlas const&              atlas,
+                     std::uint32_t                     index,
+                     std::size_t                       begin,
+                     std::size_t                       end,
+                     std::vector<std::uint32_t> const* vertexRemap,
+                     bool                              normalized,
+                     char*                             mapping,
+                     std::ptrdiff_t                    mappingStride,
+                     char*                             uvs,
+                     std::ptrdiff_t                    uvStride,
+                     UvEncoding                        encoding);
+
+// Returns `(mapping, indices, uvs)` of a mesh in the given format, or `(vertices, indices)` if it is interleaved.
+// The mapping is looked up in `vertexRemap` if it is not null. The output is read without the GIL, so the caller must keep
+// the atlas from being changed (e.g. with a `ReadScope` of its `Atlas`).
+pybind11::tuple encodeMesh(xatlas::Atlas const&              atlas,
+                           std::uint32_t                     index,
+                           std::vector<std::uint32_t> const* vertexRemap,
+                           OutputFormat const&               format);
@@ -0,0 +1,170 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+constexpr std::uint64_t const prime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t const prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t const prime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t const prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t const prime5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t rotl(std::uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// Reads little endian values regardless of alignment (all supported platforms are little endian)
+inline std::uint64_t read64(std::uint8_t const* p)
+{
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t read32(std::uint8_t const* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint64_t roundStep(std::uint64_t accumulator, std::uint64_t input)
+{
+    accumulator += input * prime2;
+    accumulator = rotl(accumulator, 31);
+    return accumulator * prime1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t value)
+{
+    accumulator ^= roundStep(0, value);
+    return accumulator * prime1 + prime4;
+}
+
+} // namespace
+
+Hasher::Hasher(std::uint64_t seed)
+    : m_state{seed + prime1 + prime2, seed + prime2, seed, seed - prime1}
+    , m_buffer{}
+    , m_buffered(0)
+    , m_length(0)
+    , m_seed(seed)
+{
+}
+
+void Hasher::update(void const* data, std::size_t size)
+{
+    auto const* p   = static_cast<std::uint8_t const*>(data);
+    auto const* end = p + size;
+
+    m_length += size;
+
+    // Complete a partial stripe first
+    if (m_buffered > 0)
+    {
+        std::size_t const n = std::min(size, sizeof(m_buffer) - m_buffered);
+        std::memcpy(m_buffer + m_buffered, p, n);
+        m_buffered += n;
+        p += n;
+        if (m_buffered < sizeof(m_buffer))
+        {
+            return;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            m_state[i] = roundStep(m_state[i], read64(m_buffer + 8 * i));
+        }
+        m_buffered = 0;
+    }
+
+    // Full stripes directly from the input
+    for (; end - p >= 32; p += 32)
+    {
+        m_state[0] = roundStep(m_state[0], read64(p));
+        m_state[1] = roundStep(m_state[1], read64(p + 8));
+        m_state[2] = roundStep(m_state[2], read64(p + 16));
+        m_state[3] = roundStep(m_state[3], read64(p + 24));
+    }
+
+    if (p < end)
+    {
+        m_buffered = static_cast<std::size_t>(end - p);
+        std::memcpy(m_buffer, p, m_buffered);
+    }
+}
+
+std::uint64_t Hasher::digest() const
+{
+    std::uint64_t hash;
+    if (m_length >= 32)
+    {
+        hash = rotl(m_state[0], 1) + rotl(m_state[1], 7) + rotl(m_state[2], 12) + rotl(m_state[3], 18);
+        for (std::uint64_t state : m_state)
+        {
+            hash = mergeRound(hash, state);
+        }
+    }
+    else
+    {
+        hash = m_seed + prime5;
+    }
+
+    hash += m_length;
+
+    // Remaining bytes of the last partial stripe
+    std::uint8_t const* p   = m_buffer;
+    std::uint8_t const* end = m_buffer + m_buffered;
+    for (; end - p >= 8; p += 8)
+    {
+        hash ^= roundStep(0, read64(p));
+        hash = rotl(hash, 27) * prime1 + prime4;
+    }
+    if (end - p >= 4)
+    {
+        hash ^= static_cast<std::uint64_t>(read32(p)) * prime1;
+        hash = rotl(hash, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        hash ^= (*p) * prime5;
+        hash = rotl(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
@@ -0,0 +1,56 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Streaming XXH64 (https://github.com/Cyan4973/xxHash), used to identify inputs and options for caching.
+// The digest equals XXH64 of the concatenated data.
+class Hasher
+{
+public:
+    explicit Hasher(std::uint64_t seed = 0);
+
+    void update(void const* data, std::size_t size);
+
+    // Hashes the object representation, so `T` must not contain padding
+    template<typename T>
+    void update(T const& value)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Only scalars can be hashed by value");
+        update(&value, sizeof(T));
+    }
+
+    std::uint64_t digest() const;
+
+private:
+    std::uint64_t m_state[4];
+    std::uint8_t  m_buffer[32];
+    std::size_t   m_buffered;
+    std::uint64_t m_length;
+    std::uint64_t m_seed;
+};
@@ -0,0 +1,564 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "incremental.hpp"
+#include "threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+constexpr std::uint32_t const blockSize = 4; // Texels per side of an occupancy block
+
+// Occupied blocks of each sub-atlas. Besides the blocks, each sub-atlas keeps the free blocks below every block
+// and the longest free run of every row, which are built once and then updated for each placed chart.
+class Occupancy
+{
+public:
+    Occupancy(std::uint32_t width, std::uint32_t height, std::uint32_t atlasCount)
+        : m_columns(width / blockSize)
+        , m_rows(height / blockSize)
+        , m_atlases(atlasCount)
+    {
+        for (Blocks& blocks : m_atlases)
+        {
+            clear(blocks);
+        }
+    }
+
+    std::uint32_t columns() const { return m_columns; }
+    std::uint32_t rows() const { return m_rows; }
+    std::uint32_t atlasCount() const { return static_cast<std::uint32_t>(m_atlases.size()); }
+
+    void addAtlas()
+    {
+        m_atlases.emplace_back();
+        clear(m_atlases.back());
+    }
+
+    // Marks the blocks overlapping the texel rectangle [minX, maxX] x [minY, maxY]
+    void markTexels(std::uint32_t atlas, float minX, float minY, float maxX, float maxY)
+    {
+        if (!(maxX >= 0.0f && maxY >= 0.0f && minX < float(m_columns * blockSize) && minY < float(m_rows * blockSize)))
+        {
+            return;
+        }
+
+        std::uint32_t const x0 = static_cast<std::uint32_t>(std::max(minX, 0.0f)) / blockSize;
+        std::uint32_t const y0 = static_cast<std::uint32_t>(std::max(minY, 0.0f)) / blockSize;
+        std::uint32_t const x1 = std::min(static_cast<std::uint32_t>(maxX) / blockSize, m_columns - 1);
+        std::uint32_t const y1 = std::min(static_cast<std::uint32_t>(maxY) / blockSize, m_rows - 1);
+
+        // The search structures are rebuilt once before the next search
+        Blocks& blocks = m_atlases[atlas];
+        for (std::uint32_t row = y0; row <= y1; ++row)
+        {
+            std::fill_n(blocks.occupied.begin() + std::size_t(row) * m_columns + x0, x1 - x0 + 1, std::uint8_t(1));
+        }
+        blocks.stale = true;
+    }
+
+    // Marks the blocks of a placed chart and updates the search structures around them
+    void place(std::uint32_t atlas, std::uint32_t x, std::uint32_t y, std::uint32_t width, std::uint32_t height)
+    {
+        Blocks& blocks = m_atlases[atlas];
+        for (std::uint32_t row = y; row < y + height; ++row)
+        {
+            std::fill_n(blocks.occupied.begin() + std::size_t(row) * m_columns + x, width, std::uint8_t(1));
+        }
+        if (blocks.stale)
+        {
+            return;
+        }
+
+        // Only the free blocks directly above the chart reach down to it
+        for (std::uint32_t column = x; column < x + width; ++column)
+        {
+            for (std::uint32_t row = y; row < y + height; ++row)
+            {
+                blocks.freeBelow[std::size_t(row) * m_columns + column] = 0;
+            }
+            for (std::uint32_t row = y; row > 0 && !blocks.occupied[std::size_t(row - 1) * m_columns + column]; --row)
+            {
+                blocks.freeBelow[std::size_t(row - 1) * m_columns + column] = blocks.freeBelow[std::size_t(row) * m_columns + column] + 1;
+            }
+        }
+
+        for (std::uint32_t row = y; row < y + height; ++row)
+        {
+            updateLongestRun(blocks, row);
+        }
+    }
+
+    // Finds the first free rectangle of `width` x `height` blocks (top to bottom, left to right)
+    bool find(std::uint32_t atlas, std::uint32_t width, std::uint32_t height, std::uint32_t& x, std::uint32_t& y, unsigned int threadCount)
+    {
+        if (width > m_columns || height > m_rows)
+        {
+            return false;
+        }
+
+        Blocks& blocks = m_atlases[atlas];
+        if (blocks.stale)
+        {
+            rebuild(blocks, threadCount);
+        }
+
+        // Rows whose following `height` rows all have a long enough free run, the others are skipped
+        std::uint32_t const        candidates = m_rows - height + 1;
+        std::vector<std::uint32_t> rows;
+        std::uint32_t              runRows = 0;
+        for (std::uint32_t row = m_rows; row-- > 0;)
+        {
+            runRows = blocks.longestRun[row] >= width ? runRows + 1 : 0;
+            if (row < candidates && runRows >= height)
+            {
+                rows.push_back(row);
+            }
+        }
+        std::reverse(rows.begin(), rows.end());
+
+        // First free column of the candidate rows, searched in parallel. Rows below a found one are skipped.
+        std::uint32_t const        none = std::numeric_limits<std::uint32_t>::max();
+        std::atomic<std::uint32_t> first{none};
+        std::vector<std::uint32_t> firstColumn(rows.size(), none);
+        parallelFor(rows.size(), 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end && i < first.load(std::memory_order_relaxed); ++i)
+            {
+                std::uint32_t const* freeBelow = blocks.freeBelow.data() + std::size_t(rows[i]) * m_columns;
+                std::uint32_t        run       = 0;
+                for (std::uint32_t column = 0; column < m_columns; ++column)
+                {
+                    run = freeBelow[column] >= height ? run + 1 : 0;
+                    if (run == width)
+                    {
+                        firstColumn[i] = column + 1 - width;
+                        break;
+                    }
+                }
+
+                if (firstColumn[i] != none)
+                {
+                    std::uint32_t found = first.load(std::memory_order_relaxed);
+                    while (i < found && !first.compare_exchange_weak(found, static_cast<std::uint32_t>(i), std::memory_order_relaxed))
+                    {
+                    }
+                    break;
+                }
+            }
+        }, threadCount);
+
+        std::uint32_t const found = first.load();
+        if (found == none)
+        {
+            return false;
+        }
+
+        y = rows[found];
+        x = firstColumn[found];
+        return true;
+    }
+
+private:
+    struct Blocks
+    {
+        std::vector<std::uint8_t>  occupied;
+        std::vector<std::uint32_t> freeBelow;  // Free blocks from each block downwards, including itself
+        std::vector<std::uint32_t> longestRun; // Longest horizontal run of free blocks of each row
+        bool                       stale = false;
+    };
+
+    void clear(Blocks& blocks) const
+    {
+        blocks.occupied.assign(std::size_t(m_columns) * m_rows, 0);
+        blocks.freeBelow.resize(std::size_t(m_columns) * m_rows);
+        for (std::uint32_t row = 0; row < m_rows; ++row)
+        {
+            std::fill_n(blocks.freeBelow.begin() + std::size_t(row) * m_columns, m_columns, m_rows - row);
+        }
+        blocks.longestRun.assign(m_rows, m_columns);
+        blocks.stale = false;
+    }
+
+    void rebuild(Blocks& blocks, unsigned int threadCount) const
+    {
+        parallelFor(m_columns, 64, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t column = begin; column < end; ++column)
+            {
+                std::uint32_t free = 0;
+                for (std::uint32_t row = m_rows; row-- > 0;)
+                {
+                    std::size_t const block = std::size_t(row) * m_columns + column;
+                    free                    = blocks.occupied[block] ? 0 : free + 1;
+                    blocks.freeBelow[block] = free;
+                }
+            }
+        }, threadCount);
+
+        parallelFor(m_rows, 64, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t row = begin; row < end; ++row)
+            {
+                updateLongestRun(blocks, static_cast<std::uint32_t>(row));
+            }
+        }, threadCount);
+
+        blocks.stale = false;
+    }
+
+    void updateLongestRun(Blocks& blocks, std::uint32_t row) const
+    {
+        std::uint8_t const* occupied = blocks.occupied.data() + std::size_t(row) * m_columns;
+        std::uint32_t       longest  = 0;
+        std::uint32_t       run      = 0;
+        for (std::uint32_t column = 0; column < m_columns; ++column)
+        {
+            run     = occupied[column] ? 0 : run + 1;
+            longest = std::max(longest, run);
+        }
+        blocks.longestRun[row] = longest;
+    }
+
+    std::uint32_t       m_columns;
+    std::uint32_t       m_rows;
+    std::vector<Blocks> m_atlases;
+};
+
+struct ChartPlacement
+{
+    std::uint32_t mesh;
+    std::uint32_t chart;
+    std::int32_t  globalIndex = -1; // Chart index of the vertices and the image
+    float         minX        = std::numeric_limits<float>::max();
+    float         minY        = std::numeric_limits<float>::max();
+    float         maxX        = std::numeric_limits<float>::lowest();
+    float         maxY        = std::numeric_limits<float>::lowest();
+    double        area        = 0.0; // In texels
+    std::uint32_t atlas       = 0;
+    std::int32_t  dx          = 0;
+    std::int32_t  dy          = 0;
+    bool          placed      = false;
+};
+
+} // namespace
+
+std::vector<char> packIncremental(xatlas::Atlas const&      base,
+                                  VertexRemaps const*       baseRemaps,
+                                  xatlas::Atlas const&      added,
+                                  VertexRemaps const*       addedRemaps,
+                                  IncrementalOptions const& options,
+                                  unsigned int              threadCount)
+{
+    std::uint32_t const padding = options.padding;
+
+    // Bounds of the added charts in the texel space of `added`
+    std::vector<ChartPlacement> placements;
+    for (std::uint32_t m = 0; m < added.meshCount; ++m)
+    {
+        auto const& mesh = added.meshes[m];
+        for (std::uint32_t c = 0; c < mesh.chartCount; ++c)
+        {
+            auto const&    chart = mesh.chartArray[c];
+            ChartPlacement placement;
+            placement.mesh  = m;
+            placement.chart = c;
+            for (std::uint32_t f = 0; f < chart.faceCount; ++f)
+            {
+                std::uint32_t const* corners = mesh.indexArray + std::size_t(chart.faceArray[f]) * 3;
+                xatlas::Vertex const& a      = mesh.vertexArray[corners[0]];
+                xatlas::Vertex const& b      = mesh.vertexArray[corners[1]];
+                xatlas::Vertex const& c_     = mesh.vertexArray[corners[2]];
+                for (xatlas::Vertex const* vertex : {&a, &b, &c_})
+                {
+                    placement.minX = std::min(placement.minX, vertex->uv[0]);
+                    placement.minY = std::min(placement.minY, vertex->uv[1]);
+                    placement.maxX = std::max(placement.maxX, vertex->uv[0]);
+                    placement.maxY = std::max(placement.maxY, vertex->uv[1]);
+                }
+                placement.globalIndex = a.chartIndex;
+                placement.area += 0.5 * std::fabs(double(b.uv[0] - a.uv[0]) * double(c_.uv[1] - a.uv[1]) - double(b.uv[1] - a.uv[1]) * double(c_.uv[0] - a.uv[0]));
+            }
+
+            if (chart.faceCount > 0 && !(std::isfinite(placement.minX) && std::isfinite(placement.minY) && std::isfinite(placement.maxX) && std::isfinite(placement.maxY)))
+            {
+                throw std::runtime_error("Chart " + std::to_string(c) + " of added mesh " + std::to_string(m) + " has invalid texture coordinates.");
+            }
+            placements.push_back(placement);
+        }
+    }
+
+    // Place large charts first
+    std::vector<std::size_t> order(placements.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        auto const extent = [](ChartPlacement const& p) { return double(p.maxX - p.minX) * double(p.maxY - p.minY); };
+        return extent(placements[a]) > extent(placements[b]);
+    });
+
+    std::uint32_t width      = base.width;
+    std::uint32_t height     = base.height;
+    std::uint32_t atlasCount = base.atlasCount;
+
+    // Marks the triangles of `base` and the charts placed so far (again after growing)
+    auto const buildOccupancy = [&]() {
+        Occupancy occupancy(width, height, atlasCount);
+        for (std::uint32_t m = 0; m < base.meshCount; ++m)
+        {
+            auto const& mesh = base.meshes[m];
+            for (std::uint32_t f = 0; f < mesh.indexCount / 3; ++f)
+            {
+                xatlas::Vertex const& a = mesh.vertexArray[mesh.indexArray[f * 3 + 0]];
+                xatlas::Vertex const& b = mesh.vertexArray[mesh.indexArray[f * 3 + 1]];
+                xatlas::Vertex const& c = mesh.vertexArray[mesh.indexArray[f * 3 + 2]];
+                if (a.atlasIndex < 0 || static_cast<std::uint32_t>(a.atlasIndex) >= base.atlasCount)
+                {
+                    continue;
+                }
+
+                occupancy.markTexels(static_cast<std::uint32_t>(a.atlasIndex),
+                                     std::min({a.uv[0], b.uv[0], c.uv[0]}) - float(padding),
+                                     std::min({a.uv[1], b.uv[1], c.uv[1]}) - float(padding),
+                                     std::max({a.uv[0], b.uv[0], c.uv[0]}) + float(padding),
+                                     std::max({a.uv[1], b.uv[1], c.uv[1]}) + float(padding));
+            }
+        }
+
+        for (ChartPlacement const& placement : placements)
+        {
+            if (placement.placed)
+            {
+                occupancy.markTexels(placement.atlas,
+                                     placement.minX + float(placement.dx) - float(padding),
+                                     placement.minY + float(placement.dy) - float(padding),
+                                     placement.maxX + float(placement.dx) + float(padding),
+                                     placement.maxY + float(placement.dy) + float(padding));
+            }
+        }
+        return occupancy;
+    };
+
+    Occupancy occupancy = buildOccupancy();
+    for (std::size_t index : order)
+    {
+        ChartPlacement& placement = placements[index];
+        if (placement.minX > placement.maxX)
+        {
+            continue; // No faces
+        }
+
+        // Texels of the chart including the padding on both sides, in whole blocks
+        float const         originX = std::floor(placement.minX);
+        float const         originY = std::floor(placement.minY);
+        std::uint32_t const texelsX = static_cast<std::uint32_t>(std::ceil(placement.maxX) - originX) + 1 + 2 * padding;
+        std::uint32_t const texelsY = static_cast<std::uint32_t>(std::ceil(placement.maxY) - originY) + 1 + 2 * padding;
+        std::uint32_t const blocksX = (texelsX + blockSize - 1) / blockSize;
+        std::uint32_t const blocksY = (texelsY + blockSize - 1) / blockSize;
+
+        std::uint32_t x     = 0;
+        std::uint32_t y     = 0;
+        bool          found = false;
+        while (!found)
+        {
+            for (std::uint32_t atlas = 0; atlas < occupancy.atlasCount() && !found; ++atlas)
+            {
+                if (occupancy.find(atlas, blocksX, blocksY, x, y, threadCount))
+                {
+                    placement.atlas = atlas;
+                    found           = true;
+                }
+            }
+            if (found)
+            {
+                break;
+            }
+
+            // Grow the smaller side, then spill into a new sub-atlas
+            std::uint32_t& side = width <= height ? width : height;
+            if (options.grow && (options.maxSize == 0 || std::uint64_t(side) * 2 <= options.maxSize) && side <= (1U << 30))
+            {
+                side *= 2;
+                occupancy = buildOccupancy();
+            }
+            else if (options.spill && blocksX <= occupancy.columns() && blocksY <= occupancy.rows())
+            {
+                ++atlasCount;
+                occupancy.addAtlas();
+            }
+            else
+            {
+                throw std::runtime_error("Chart " + std::to_string(placement.chart) + " of added mesh " + std::to_string(placement.mesh) + " does not fit into the atlas.");
+            }
+        }
+
+        placement.dx     = static_cast<std::int32_t>(x * blockSize + padding - originX);
+        placement.dy     = static_cast<std::int32_t>(y * blockSize + padding - originY);
+        placement.placed = true;
+        occupancy.place(placement.atlas, x, y, blocksX, blocksY);
+    }
+
+    // Placement of each chart by the chart index of the vertices and the image of `added`
+    std::vector<ChartPlacement const*> byGlobalIndex(added.chartCount, nullptr);
+    for (ChartPlacement const& placement : placements)
+    {
+        if (placement.placed && placement.globalIndex >= 0 && static_cast<std::uint32_t>(placement.globalIndex) < added.chartCount)
+        {
+            byGlobalIndex[placement.globalIndex] = &placement;
+        }
+    }
+
+    // Outputs of the added meshes, moved to their placements
+    std::vector<std::vector<xatlas::Vertex>> vertices(added.meshCount);
+    std::vector<std::vector<xatlas::Chart>>  charts(added.meshCount);
+    std::vector<xatlas::Mesh>                meshes(base.meshes, base.meshes + base.meshCount);
+    for (std::uint32_t m = 0; m < added.meshCount; ++m)
+    {
+        auto const& mesh = added.meshes[m];
+        vertices[m].assign(mesh.vertexArray, mesh.vertexArray + mesh.vertexCount);
+        charts[m].assign(mesh.chartArray, mesh.chartArray + mesh.chartCount);
+
+        for (xatlas::Vertex& vertex : vertices[m])
+        {
+            if (vertex.chartIndex < 0 || static_cast<std::uint32_t>(vertex.chartIndex) >= added.chartCount || !byGlobalIndex[vertex.chartIndex])
+            {
+                continue;
+            }
+
+            ChartPlacement const& placement = *byGlobalIndex[vertex.chartIndex];
+            vertex.uv[0] += float(placement.dx);
+            vertex.uv[1] += float(placement.dy);
+            vertex.atlasIndex = static_cast<std::int32_t>(placement.atlas);
+            vertex.chartIndex += static_cast<std::int32_t>(base.chartCount);
+        }
+
+        meshes.push_back(mesh);
+        meshes.back().vertexArray = vertices[m].data();
+        meshes.back().chartArray  = charts[m].data();
+    }
+
+    for (ChartPlacement const& placement : placements)
+    {
+        charts[placement.mesh][placement.chart].atlasIndex = placement.atlas;
+    }
+
+    // Utilization relative to the (grown) size
+    double const       area = double(width) * double(height);
+    std::vector<float> utilization(atlasCount, 0.0f);
+    std::vector<double> usedTexels(atlasCount, 0.0);
+    for (std::uint32_t a = 0; a < base.atlasCount; ++a)
+    {
+        usedTexels[a] = double(base.utilization[a]) * double(base.width) * double(base.height);
+    }
+    for (ChartPlacement const& placement : placements)
+    {
+        usedTexels[placement.atlas] += placement.area;
+    }
+    for (std::uint32_t a = 0; a < atlasCount; ++a)
+    {
+        utilization[a] = static_cast<float>(std::min(usedTexels[a] / area, 1.0));
+    }
+
+    // The image is only kept if both atlases have one
+    bool const                 hasImage = base.image && added.image;
+    std::vector<std::uint32_t> image;
+    if (hasImage)
+    {
+        image.assign(std::size_t(atlasCount) * width * height, 0);
+        for (std::uint32_t a = 0; a < base.atlasCount; ++a)
+        {
+            for (std::uint32_t y = 0; y < base.height; ++y)
+            {
+                std::memcpy(image.data() + (std::size_t(a) * height + y) * width, base.image + (std::size_t(a) * base.height + y) * base.width, sizeof(std::uint32_t) * base.width);
+            }
+        }
+
+        for (std::uint32_t a = 0; a < added.atlasCount; ++a)
+        {
+            for (std::uint32_t y = 0; y < added.height; ++y)
+            {
+                for (std::uint32_t x = 0; x < added.width; ++x)
+                {
+                    std::uint32_t const data  = added.image[(std::size_t(a) * added.height + y) * added.width + x];
+                    std::uint32_t const chart = data & xatlas::kImageChartIndexMask;
+                    if (!(data & xatlas::kImageHasChartIndexBit) || chart >= added.chartCount || !byGlobalIndex[chart])
+                    {
+                        continue;
+                    }
+
+                    ChartPlacement const& placement = *byGlobalIndex[chart];
+                    std::int64_t const    tx        = std::int64_t(x) + placement.dx;
+                    std::int64_t const    ty        = std::int64_t(y) + placement.dy;
+                    if (tx < 0 || ty < 0 || tx >= width || ty >= height)
+                    {
+                        continue;
+                    }
+
+                    std::uint32_t& target = image[(std::size_t(placement.atlas) * height + std::size_t(ty)) * width + std::size_t(tx)];
+                    if (target == 0)
+                    {
+                        target = (data & ~xatlas::kImageChartIndexMask) | (chart + base.chartCount);
+                    }
+                }
+            }
+        }
+    }
+
+    xatlas::Atlas composed;
+    composed.image         = hasImage ? image.data() : nullptr;
+    composed.meshes        = meshes.data();
+    composed.utilization   = utilization.data();
+    composed.width         = width;
+    composed.height        = height;
+    composed.atlasCount    = atlasCount;
+    composed.chartCount    = base.chartCount + added.chartCount;
+    composed.meshCount     = static_cast<std::uint32_t>(meshes.size());
+    composed.texelsPerUnit = base.texelsPerUnit;
+
+    // Both outputs refer to the original vertices afterwards
+    VertexRemaps remaps(composed.meshCount);
+    for (std::uint32_t m = 0; m < base.meshCount; ++m)
+    {
+        if (baseRemaps && m < baseRemaps->size())
+        {
+            remaps[m] = (*baseRemaps)[m];
+        }
+    }
+    for (std::uint32_t m = 0; m < added.meshCount; ++m)
+    {
+        if (addedRemaps && m < addedRemaps->size())
+        {
+            remaps[base.meshCount + m] = (*addedRemaps)[m];
+        }
+    }
+
+    std::vector<char> buffer(serializedSize(composed, hasImage));
+    serializeAtlas(composed, hasImage, buffer.data(), &remaps);
+    return buffer;
+}
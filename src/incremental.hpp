@@ -0,0 +1,53 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "serialization.hpp"
+
+#include <xatlas.h>
+
+#include <cstdint>
+#include <vector>
+
+// Placement of the charts of an atlas into the free space of another one
+struct IncrementalOptions
+{
+    std::uint32_t padding = 1;     // Texels between the added charts and any other chart
+    bool          grow    = false; // Double the size of the atlas (the smaller side first) if a chart does not fit
+    std::uint32_t maxSize = 0;     // Maximum width and height when growing (0 for no limit)
+    bool          spill   = true;  // Add a new sub-atlas if a chart does not fit (and the atlas cannot grow)
+};
+
+// Packs the charts of `added` into the free space of `base` without moving the charts of `base`, and returns
+// the serialized output of both (see serialization.hpp). Charts are placed as rectangles on a grid of 4x4 texel
+// blocks, where a block is free if no triangle of `base` (or previously placed chart) overlaps it. Chart and atlas
+// indices, utilization and the image (if both atlases have one) are updated accordingly.
+// Both atlases must have the same texels per unit. Throws std::runtime_error if a chart does not fit.
+std::vector<char> packIncremental(xatlas::Atlas const&      base,
+                                  VertexRemaps const*       baseRemaps,
+                                  xatlas::Atlas const&      added,
+                                  VertexRemaps const*       addedRemaps,
+                                  IncrementalOptions const& options,
+                                  unsigned int              threadCount = 0);
@@ -0,0 +1,291 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "io.hpp"
+#include "loader.hpp"
+#include "threading.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace
+{
+
+// Upper bounds for the length of a formatted float/index and of a full line
+constexpr size_t const maxFloatLength = 32;
+constexpr size_t const maxIndexLength = 20;
+constexpr size_t const maxVertexLine  = 4 + 3 * (maxFloatLength + 1);
+constexpr size_t const maxFaceLine    = 4 + 3 * (3 * maxIndexLength + 3);
+
+// Lines formatted per chunk. Chunks are formatted independently and written in order.
+constexpr size_t const linesPerChunk = 1 << 14;
+
+// Formats a float like `std::ostream` with default settings (i.e. `%g`)
+inline char* formatFloat(char* out, float value)
+{
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(out, out + maxFloatLength, value, std::chars_format::general, 6).ptr;
+#else
+    // Floating point `std::to_chars` is not available in all standard libraries
+    return out + std::snprintf(out, maxFloatLength, "%g", static_cast<double>(value));
+#endif
+}
+
+inline char* formatIndex(char* out, size_t index)
+{
+    return std::to_chars(out, out + maxIndexLength, index).ptr;
+}
+
+inline char* formatFloats(char* out, char const* prefix, float const* values, size_t count)
+{
+    for (; *prefix; ++prefix)
+    {
+        *out++ = *prefix;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            *out++ = ' ';
+        }
+        out = formatFloat(out, values[i]);
+    }
+
+    *out++ = '\n';
+    return out;
+}
+
+// Face vertex in the form `v`, `v/vt`, `v//vn` or `v/vt/vn`, with the same index for all attributes
+inline char* formatFaceVertex(char* out, size_t index, bool hasUvs, bool hasNormals)
+{
+    char* const begin = out;
+    out               = formatIndex(out, index);
+    size_t const size = static_cast<size_t>(out - begin);
+
+    if (hasUvs || hasNormals)
+    {
+        *out++ = '/';
+        if (hasUvs)
+        {
+            out = std::copy_n(begin, size, out);
+        }
+        if (hasNormals)
+        {
+            *out++ = '/';
+            out    = std::copy_n(begin, size, out);
+        }
+    }
+
+    return out;
+}
+
+// Writes `count` lines, produced by `formatLine(out, i)` into a buffer of at least `maxLineLength` characters.
+// Large outputs are formatted in chunks on multiple threads, but always written in order.
+template<typename Formatter>
+void writeLines(std::ofstream& file, size_t count, size_t maxLineLength, Formatter const& formatLine, unsigned int numThreads)
+{
+    size_t const chunkCount  = (count + linesPerChunk - 1) / linesPerChunk;
+    size_t const threadCount = std::min<size_t>(numThreads == 0 ? defaultThreadCount() : numThreads, chunkCount);
+
+    std::vector<std::vector<char>> buffers(std::max<size_t>(threadCount, 1));
+    std::vector<size_t>            sizes(buffers.size());
+    for (auto& buffer : buffers)
+    {
+        buffer.resize(std::min(count, linesPerChunk) * maxLineLength);
+    }
+
+    auto formatChunk = [&](size_t chunk, size_t slot) {
+        size_t const begin = chunk * linesPerChunk;
+        size_t const end   = std::min(begin + linesPerChunk, count);
+
+        char* const start = buffers[slot].data();
+        char*       out   = start;
+        for (size_t i = begin; i < end; ++i)
+        {
+            out = formatLine(out, i);
+        }
+        sizes[slot] = static_cast<size_t>(out - start);
+    };
+
+    // Format one chunk per thread, then write them in order
+    for (size_t firstChunk = 0; firstChunk < chunkCount; firstChunk += buffers.size())
+    {
+        size_t const waveSize = std::min(buffers.size(), chunkCount - firstChunk);
+
+        parallelFor(waveSize, 1, [&](size_t begin, size_t end) {
+            for (size_t slot = begin; slot < end; ++slot)
+            {
+                formatChunk(firstChunk + slot, slot);
+            }
+        }, static_cast<unsigned int>(buffers.size()));
+
+        for (size_t slot = 0; slot < waveSize; ++slot)
+        {
+            file.write(buffers[slot].data(), static_cast<std::streamsize>(sizes[slot]));
+        }
+    }
+}
+
+// Moves a vector into a numpy array with `columns` columns without copying the data
+template<typename T>
+py::array_t<T> toArray(std::vector<T>&& values, size_t columns)
+{
+    auto*       owner = new std::vector<T>(std::move(values));
+    py::capsule capsule(owner, [](void* data) { delete static_cast<std::vector<T>*>(data); });
+
+    return py::array_t<T>(py::array::ShapeContainer{owner->size() / columns, columns}, owner->data(), capsule);
+}
+
+LoadResult toArrays(MeshData&& mesh)
+{
+    std::optional<py::array_t<float>> normals;
+    if (!mesh.normals.empty())
+    {
+        normals = toArray(std::move(mesh.normals), 3);
+    }
+
+    std::optional<py::array_t<float>> uvs;
+    if (!mesh.uvs.empty())
+    {
+        uvs = toArray(std::move(mesh.uvs), 2);
+    }
+
+    return std::make_tuple(toArray(std::move(mesh.positions), 3), toArray(std::move(mesh.indices), 3), normals, uvs);
+}
+
+} // namespace
+
+LoadResult loadObj(std::string const& path, unsigned int numThreads)
+{
+    MeshData mesh;
+    {
+        py::gil_scoped_release release;
+        mesh = readObj(path, numThreads);
+    }
+
+    return toArrays(std::move(mesh));
+}
+
+LoadResult loadPly(std::string const& path)
+{
+    MeshData mesh;
+    {
+        py::gil_scoped_release release;
+        mesh = readPly(path);
+    }
+
+    return toArrays(std::move(mesh));
+}
+
+void exportObj(std::string const&                            path,
+               ContiguousArray<float> const&                 positions,
+               std::optional<ContiguousArray<std::uint32_t>> indices,
+               std::optional<ContiguousArray<float>>         uvs,
+               std::optional<ContiguousArray<float>>         normals,
+               unsigned int                                  numThreads)
+{
+    // Perform sanity checks on the inputs
+    checkShape("Position", positions, 3);
+    if (indices)
+    {
+        checkShape("Index", *indices, 3);
+    }
+    if (normals)
+    {
+        checkShape("Normal", *normals, 3, positions.shape(0));
+    }
+    if (uvs)
+    {
+        checkShape("Texture coordinates", *uvs, 2, positions.shape(0));
+    }
+
+    // The output is written in large blocks and never flushed explicitly.
+    // Text mode keeps the line endings identical to writing line by line.
+    std::ofstream file(path);
+
+    if (!file.is_open())
+    {
+        throw std::invalid_argument("Cannot open path " + path);
+    }
+
+    // The arrays are referenced by the caller for the duration of the call
+    py::gil_scoped_release release;
+
+    // Write the vertex positions
+    float const* positionData = positions.data();
+    writeLines(file, static_cast<size_t>(positions.shape(0)), maxVertexLine, [&](char* out, size_t v) {
+        return formatFloats(out, "v ", positionData + 3 * v, 3);
+    }, numThreads);
+
+    // Write the vertex normals
+    if (normals)
+    {
+        float const* normalData = normals->data();
+        writeLines(file, static_cast<size_t>(normals->shape(0)), maxVertexLine, [&](char* out, size_t v) {
+            return formatFloats(out, "vn ", normalData + 3 * v, 3);
+        }, numThreads);
+    }
+
+    // Write the vertex uv coordinates
+    if (uvs)
+    {
+        float const* uvData = uvs->data();
+        writeLines(file, static_cast<size_t>(uvs->shape(0)), maxVertexLine, [&](char* out, size_t v) {
+            return formatFloats(out, "vt ", uvData + 2 * v, 2);
+        }, numThreads);
+    }
+
+    // Write the faces
+    if (indices)
+    {
+        std::uint32_t const* indexData  = indices->data();
+        bool const           hasUvs     = uvs.has_value();
+        bool const           hasNormals = normals.has_value();
+        writeLines(file, static_cast<size_t>(indices->shape(0)), maxFaceLine, [&](char* out, size_t f) {
+            *out++ = 'f';
+            for (size_t i = 0; i < 3; ++i)
+            {
+                *out++ = ' ';
+                out    = formatFaceVertex(out, static_cast<size_t>(indexData[3 * f + i]) + 1, hasUvs, hasNormals);
+            }
+            *out++ = '\n';
+            return out;
+        }, numThreads);
+    }
+
+    file.flush();
+    if (!file)
+    {
+        throw std::runtime_error("Writing to path " + path + " failed");
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "utils.hpp"
+
+#include <pybind11/numpy.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+
+using LoadResult = std::tuple<
+    pybind11::array_t<float>,                // Positions
+    pybind11::array_t<std::uint32_t>,        // Indices
+    std::optional<pybind11::array_t<float>>, // Normals (`None` if not available)
+    std::optional<pybind11::array_t<float>>  // Texture coordinates (`None` if not available)
+>;
+
+void exportObj(std::string const&                            path,
+               ContiguousArray<float> const&                 positions,
+               std::optional<ContiguousArray<std::uint32_t>> indices    = std::nullopt,
+               std::optional<ContiguousArray<float>>         uvs        = std::nullopt,
+               std::optional<ContiguousArray<float>>         normals    = std::nullopt,
+               unsigned int                                  numThreads = 0);
+
+LoadResult loadObj(std::string const& path, unsigned int numThreads = 0);
+
+LoadResult loadPly(std::string const& path);
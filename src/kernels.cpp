@@ -0,0 +1,277 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "kernels.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XATLAS_PYTHON_SSE2
+#include <emmintrin.h>
+#endif
+
+// The vectorized code reads vertices as packed 32-bit lanes
+static_assert(sizeof(xatlas::Vertex) == 5 * sizeof(float), "Unexpected layout of xatlas::Vertex");
+static_assert(offsetof(xatlas::Vertex, uv) == 2 * sizeof(float), "Unexpected layout of xatlas::Vertex");
+static_assert(offsetof(xatlas::Vertex, xref) == 4 * sizeof(float), "Unexpected layout of xatlas::Vertex");
+
+void deinterleaveVertices(xatlas::Vertex const* vertices, std::size_t count, float scaleU, float scaleV, std::uint32_t* mapping, float* uvs)
+{
+    std::size_t v = 0;
+
+#ifdef XATLAS_PYTHON_SSE2
+    if (mapping && uvs)
+    {
+        // Process four vertices (20 lanes) at a time:
+        //   [a c u v x] [a c u v x] [a c u v x] [a c u v x]
+        // is loaded as
+        //   l0 = [a c u0 v0], l1 = [x0 a c u1], l2 = [v1 x1 a c], l3 = [u2 v2 x2 a], l4 = [c u3 v3 x3]
+        __m128 const scale = _mm_setr_ps(scaleU, scaleV, scaleU, scaleV);
+        for (; v + 4 <= count; v += 4)
+        {
+            float const* data = reinterpret_cast<float const*>(vertices + v);
+
+            __m128 const l0 = _mm_loadu_ps(data + 0);
+            __m128 const l1 = _mm_loadu_ps(data + 4);
+            __m128 const l2 = _mm_loadu_ps(data + 8);
+            __m128 const l3 = _mm_loadu_ps(data + 12);
+            __m128 const l4 = _mm_loadu_ps(data + 16);
+
+            // [u0 v0 u1 v1]
+            __m128 const uv0   = _mm_movehl_ps(l0, l0);                          // [u0 v0 u0 v0]
+            __m128 const uv1   = _mm_shuffle_ps(l1, l2, _MM_SHUFFLE(0, 0, 3, 3)); // [u1 u1 v1 v1]
+            __m128 const uv01  = _mm_shuffle_ps(uv0, uv1, _MM_SHUFFLE(2, 0, 1, 0));
+            // [u2 v2 u3 v3]
+            __m128 const uv23  = _mm_shuffle_ps(l3, l4, _MM_SHUFFLE(2, 1, 1, 0));
+            // [x0 x1 x2 x3]
+            __m128 const x01   = _mm_shuffle_ps(l1, l2, _MM_SHUFFLE(1, 1, 0, 0)); // [x0 x0 x1 x1]
+            __m128 const x23   = _mm_shuffle_ps(l3, l4, _MM_SHUFFLE(3, 3, 2, 2)); // [x2 x2 x3 x3]
+            __m128 const xrefs = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(2, 0, 2, 0));
+
+            _mm_storeu_ps(uvs + 2 * v + 0, _mm_mul_ps(uv01, scale));
+            _mm_storeu_ps(uvs + 2 * v + 4, _mm_mul_ps(uv23, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(mapping + v), _mm_castps_si128(xrefs));
+        }
+    }
+#endif
+
+    // Scalar remainder (and fallback)
+    for (; v < count; ++v)
+    {
+        auto const& vertex = vertices[v];
+
+        if (mapping)
+        {
+            mapping[v] = vertex.xref;
+        }
+
+        if (uvs)
+        {
+            uvs[2 * v + 0] = vertex.uv[0] * scaleU;
+            uvs[2 * v + 1] = vertex.uv[1] * scaleV;
+        }
+    }
+}
+
+std::uint16_t floatToHalf(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint16_t const sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000U);
+    std::uint32_t const abs  = bits & 0x7FFFFFFFU;
+
+    // Infinity and NaN (kept quiet)
+    if (abs >= 0x7F800000U)
+    {
+        return sign | 0x7C00U | (abs > 0x7F800000U ? 0x0200U : 0U);
+    }
+
+    // Rounds to 65520 or more, which overflows to infinity
+    if (abs >= 0x477FF000U)
+    {
+        return sign | 0x7C00U;
+    }
+
+    // Subnormal halfs are multiples of 2^-24, which float arithmetic rounds exactly (to nearest even)
+    if (abs < 0x38800000U)
+    {
+        float magnitude;
+        std::memcpy(&magnitude, &abs, sizeof(magnitude));
+        return sign | static_cast<std::uint16_t>(std::nearbyint(magnitude * 16777216.0f));
+    }
+
+    // Rebias the exponent and round the mantissa to nearest even. A carry into the exponent is correct.
+    std::uint32_t const rounded = abs + 0x0FFFU + ((abs >> 13) & 1U);
+    return sign | static_cast<std::uint16_t>((rounded - 0x38000000U) >> 13);
+}
+
+namespace
+{
+
+template<UvEncoding Encoding>
+void encodeVerticesAs(xatlas::Vertex const* vertices,
+                      std::size_t           count,
+                      float                 scaleU,
+                      float                 scaleV,
+                      std::uint32_t const*  remap,
+                      char*                 mapping,
+                      std::ptrdiff_t        mappingStride,
+                      char*                 uvs,
+                      std::ptrdiff_t        uvStride)
+{
+    for (std::size_t v = 0; v < count; ++v)
+    {
+        xatlas::Vertex const& vertex = vertices[v];
+
+        std::uint32_t const xref = remap ? remap[vertex.xref] : vertex.xref;
+        std::memcpy(mapping + static_cast<std::ptrdiff_t>(v) * mappingStride, &xref, sizeof(xref));
+
+        float const u   = vertex.uv[0] * scaleU;
+        float const w   = vertex.uv[1] * scaleV;
+        char* const out = uvs + static_cast<std::ptrdiff_t>(v) * uvStride;
+        if constexpr (Encoding == UvEncoding::Float32)
+        {
+            float const uv[2] = {u, w};
+            std::memcpy(out, uv, sizeof(uv));
+        }
+        else if constexpr (Encoding == UvEncoding::Float16)
+        {
+            std::uint16_t const uv[2] = {floatToHalf(u), floatToHalf(w)};
+            std::memcpy(out, uv, sizeof(uv));
+        }
+        else
+        {
+            // The comparisons also map NaN to 0
+            auto const unorm = [](float x) -> std::uint16_t {
+                return x > 0.0f ? (x < 1.0f ? static_cast<std::uint16_t>(x * 65535.0f + 0.5f) : 65535U) : 0U;
+            };
+            std::uint16_t const uv[2] = {unorm(u), unorm(w)};
+            std::memcpy(out, uv, sizeof(uv));
+        }
+    }
+}
+
+} // namespace
+
+void encodeVertices(xatlas::Vertex const* vertices,
+                    std::size_t           count,
+                    float                 scaleU,
+                    float                 scaleV,
+                    std::uint32_t const*  remap,
+                    char*                 mapping,
+                    std::ptrdiff_t        mappingStride,
+                    char*                 uvs,
+                    std::ptrdiff_t        uvStride,
+                    UvEncoding            encoding)
+{
+    switch (encoding)
+    {
+    case UvEncoding::Float32:
+        encodeVerticesAs<UvEncoding::Float32>(vertices, count, scaleU, scaleV, remap, mapping, mappingStride, uvs, uvStride);
+        break;
+    case UvEncoding::Float16:
+        encodeVerticesAs<UvEncoding::Float16>(vertices, count, scaleU, scaleV, remap, mapping, mappingStride, uvs, uvStride);
+        break;
+    case UvEncoding::UNorm16:
+        encodeVerticesAs<UvEncoding::UNorm16>(vertices, count, scaleU, scaleV, remap, mapping, mappingStride, uvs, uvStride);
+        break;
+    }
+}
+
+void narrowIndices(std::uint32_t const* indices, std::size_t count, std::uint16_t* out)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[i] = static_cast<std::uint16_t>(indices[i]);
+    }
+}
+
+namespace
+{
+
+template<typename T>
+inline T load(char const* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+template<typename Source>
+void convertVertices(char const* data, std::ptrdiff_t rowStride, std::ptrdiff_t componentStride, std::size_t count, std::size_t components, float* out)
+{
+    for (std::size_t v = 0; v < count; ++v)
+    {
+        char const* row = data + static_cast<std::ptrdiff_t>(v) * rowStride;
+        for (std::size_t c = 0; c < components; ++c)
+        {
+            *out++ = static_cast<float>(load<Source>(row + static_cast<std::ptrdiff_t>(c) * componentStride));
+        }
+    }
+}
+
+template<typename Source>
+bool convertIndices(char const* data, std::ptrdiff_t rowStride, std::ptrdiff_t componentStride, std::size_t count, std::size_t components, std::uint32_t* out)
+{
+    // Accumulate the range check instead of branching per index
+    bool valid = true;
+    for (std::size_t f = 0; f < count; ++f)
+    {
+        char const* row = data + static_cast<std::ptrdiff_t>(f) * rowStride;
+        for (std::size_t c = 0; c < components; ++c)
+        {
+            Source const index = load<Source>(row + static_cast<std::ptrdiff_t>(c) * componentStride);
+            if constexpr (std::is_signed_v<Source>)
+            {
+                valid &= index >= 0;
+            }
+            if constexpr (sizeof(Source) > sizeof(std::uint32_t))
+            {
+                valid &= static_cast<std::uint64_t>(index) <= std::numeric_limits<std::uint32_t>::max();
+            }
+            *out++ = static_cast<std::uint32_t>(index);
+        }
+    }
+
+    return valid;
+}
+
+template void convertVertices<float>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, float*);
+template void convertVertices<double>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, float*);
+
+template bool convertIndices<std::int8_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::uint8_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::int16_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::uint16_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::int32_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::uint32_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::int64_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
+template bool convertIndices<std::uint64_t>(char const*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, std::uint32_t*);
@@ -0,0 +1,72 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <xatlas.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Splits output vertices into the vertex mapping (`xref`) and the texture coordinates (`uv`),
+// which are multiplied by `scaleU` and `scaleV` (e.g. the reciprocal atlas size for normalized coordinates).
+// `mapping` has space for `count` and `uvs` for `2 * count` elements. Either of them may be null.
+void deinterleaveVertices(xatlas::Vertex const* vertices, std::size_t count, float scaleU, float scaleV, std::uint32_t* mapping, float* uvs);
+
+// Storage of texture coordinates in encoded outputs
+enum class UvEncoding
+{
+    Float32,
+    Float16, // IEEE 754 half precision (numpy's float16)
+    UNorm16  // [0, 1] mapped to [0, 65535], values outside are clamped
+};
+
+// Converts a float to half precision bits, rounding to nearest even (as numpy does).
+std::uint16_t floatToHalf(float value);
+
+// Like `deinterleaveVertices`, but writes each mapping and texture coordinate pair at a byte stride in the given encoding,
+// so that the outputs may be planar arrays or fields of an interleaved vertex buffer. The mapping is looked up in `remap` if it is not null.
+void encodeVertices(xatlas::Vertex const* vertices,
+                    std::size_t           count,
+                    float                 scaleU,
+                    float                 scaleV,
+                    std::uint32_t const*  remap,
+                    char*                 mapping,
+                    std::ptrdiff_t        mappingStride,
+                    char*                 uvs,
+                    std::ptrdiff_t        uvStride,
+                    UvEncoding            encoding);
+
+// Copies `count` indices into 16-bit indices. The indices must be smaller than 65536.
+void narrowIndices(std::uint32_t const* indices, std::size_t count, std::uint16_t* out);
+
+// Converts `count` rows of `components` values each into consecutive floats.
+// The source is addressed with byte strides and may be unaligned.
+template<typename Source>
+void convertVertices(char const* data, std::ptrdiff_t rowStride, std::ptrdiff_t componentStride, std::size_t count, std::size_t components, float* out);
+
+// Converts `count` rows of `components` integer indices each into consecutive uint32 indices.
+// Returns false if an index is negative or does not fit into uint32 (the output is incomplete then).
+template<typename Source>
+bool convertIndices(char const* data, std::ptrdiff_t rowStride, std::ptrdiff_t componentStride, std::size_t count, std::size_t components, std::uint32_t* out);
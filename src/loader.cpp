@@ -0,0 +1,860 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "loader.hpp"
+#include "mappedfile.hpp"
+#include "threading.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline char const* skipBlanks(char const* p, char const* end)
+{
+    while (p < end && isBlank(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+// Parses a floating point number at `p` and advances `p` behind it
+template<typename T>
+bool parseReal(char const*& p, char const* end, T& value)
+{
+    // Neither `std::from_chars` nor `strtod` need a leading plus
+    if (p < end && *p == '+')
+    {
+        ++p;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    auto const result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+    {
+        return false;
+    }
+    p = result.ptr;
+#else
+    // Floating point `std::from_chars` is not available in all standard libraries.
+    // `strtod` requires a null-terminated string, which the mapped file is not.
+    char   buffer[64];
+    size_t length = 0;
+    while (p + length < end && length + 1 < sizeof(buffer) && !std::isspace(static_cast<unsigned char>(p[length])))
+    {
+        buffer[length] = p[length];
+        ++length;
+    }
+    buffer[length] = '\0';
+
+    char* tail = nullptr;
+    value      = static_cast<T>(std::strtod(buffer, &tail));
+    if (tail == buffer)
+    {
+        return false;
+    }
+    p += tail - buffer;
+#endif
+
+    return true;
+}
+
+template<typename T>
+bool parseInteger(char const*& p, char const* end, T& value)
+{
+    if (p < end && *p == '+')
+    {
+        ++p;
+    }
+
+    auto const result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+    {
+        return false;
+    }
+    p = result.ptr;
+
+    return true;
+}
+
+bool hasExtension(std::string const& path, char const* extension)
+{
+    size_t const length = std::strlen(extension);
+    if (path.size() < length)
+    {
+        return false;
+    }
+
+    return std::equal(path.end() - static_cast<std::ptrdiff_t>(length), path.end(), extension, [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+}
+
+//
+// OBJ
+//
+
+// Index that is not specified (e.g. the uv index in `f 1//1`)
+constexpr std::int64_t const noIndex = -1;
+
+// Position, uv and normal index of a triangle corner (zero-based)
+struct ObjCorner
+{
+    std::array<std::int64_t, 3> index;
+};
+
+// Corner that uses a negative (relative) OBJ index. The index stored in the corner is relative to
+// the first element of its chunk and becomes absolute once the sizes of all previous chunks are known.
+struct ObjRelativeCorner
+{
+    size_t corner;
+    int    attribute;
+};
+
+// Elements of a contiguous range of lines
+struct ObjChunk
+{
+    std::vector<float>             positions;
+    std::vector<float>             uvs;
+    std::vector<float>             normals;
+    std::vector<ObjCorner>         corners; // 3 per triangle
+    std::vector<ObjRelativeCorner> relativeCorners;
+};
+
+void parseObjVector(char const* p, char const* end, size_t componentCount, size_t requiredCount, std::vector<float>& values)
+{
+    size_t i = 0;
+    for (; i < componentCount; ++i)
+    {
+        p = skipBlanks(p, end);
+
+        float value;
+        if (p == end || !parseReal(p, end, value))
+        {
+            break;
+        }
+        values.push_back(value);
+    }
+
+    if (i < requiredCount)
+    {
+        throw std::runtime_error("Invalid vertex attribute in OBJ file: " + std::string(p, end));
+    }
+
+    // Optional components (e.g. the third texture coordinate) default to zero
+    for (; i < componentCount; ++i)
+    {
+        values.push_back(0.f);
+    }
+}
+
+void parseObjFace(char const* p, char const* end, ObjChunk& chunk, std::vector<ObjCorner>& polygon, std::vector<std::array<bool, 3>>& polygonRelative)
+{
+    polygon.clear();
+    polygonRelative.clear();
+
+    std::array<size_t, 3> const counts = {chunk.positions.size() / 3, chunk.uvs.size() / 2, chunk.normals.size() / 3};
+
+    while (true)
+    {
+        // Trailing comments are common in exported files
+        p = skipBlanks(p, end);
+        if (p == end || *p == '#')
+        {
+            break;
+        }
+
+        ObjCorner            corner   = {{noIndex, noIndex, noIndex}};
+        std::array<bool, 3> relative = {false, false, false};
+        for (int attribute = 0; attribute < 3; ++attribute)
+        {
+            // Empty index (e.g. the uv index in `1//1` or the trailing ones in `1/`)
+            if (attribute > 0 && (p == end || isBlank(*p) || *p == '#'))
+            {
+                break;
+            }
+            if (attribute > 0 && *p == '/')
+            {
+                ++p;
+                continue;
+            }
+
+            std::int64_t index;
+            if (!parseInteger(p, end, index) || index == 0)
+            {
+                throw std::runtime_error("Invalid face in OBJ file: " + std::string(p, end));
+            }
+
+            if (index > 0)
+            {
+                corner.index[attribute] = index - 1;
+            }
+            else
+            {
+                corner.index[attribute] = static_cast<std::int64_t>(counts[attribute]) + index;
+                relative[attribute]     = true;
+            }
+
+            if (p == end || *p != '/')
+            {
+                break;
+            }
+            ++p;
+        }
+
+        polygon.push_back(corner);
+        polygonRelative.push_back(relative);
+    }
+
+    if (polygon.size() < 3)
+    {
+        throw std::runtime_error("OBJ face with less than 3 vertices.");
+    }
+
+    // Triangulate as a fan
+    for (size_t i = 1; i + 1 < polygon.size(); ++i)
+    {
+        for (size_t k : {size_t(0), i, i + 1})
+        {
+            for (int attribute = 0; attribute < 3; ++attribute)
+            {
+                if (polygonRelative[k][attribute])
+                {
+                    chunk.relativeCorners.push_back({chunk.corners.size(), attribute});
+                }
+            }
+            chunk.corners.push_back(polygon[k]);
+        }
+    }
+}
+
+void parseObjChunk(char const* begin, char const* end, ObjChunk& chunk)
+{
+    std::vector<ObjCorner>           polygon;
+    std::vector<std::array<bool, 3>> polygonRelative;
+
+    char const* line = begin;
+    while (line < end)
+    {
+        char const* lineEnd = static_cast<char const*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!lineEnd)
+        {
+            lineEnd = end;
+        }
+
+        char const* p = skipBlanks(line, lineEnd);
+        if (lineEnd - p >= 2 && p[0] == 'v' && isBlank(p[1]))
+        {
+            parseObjVector(p + 2, lineEnd, 3, 3, chunk.positions);
+        }
+        else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && isBlank(p[2]))
+        {
+            parseObjVector(p + 3, lineEnd, 2, 1, chunk.uvs);
+        }
+        else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && isBlank(p[2]))
+        {
+            parseObjVector(p + 3, lineEnd, 3, 3, chunk.normals);
+        }
+        else if (lineEnd - p >= 2 && p[0] == 'f' && isBlank(p[1]))
+        {
+            parseObjFace(p + 2, lineEnd, chunk, polygon, polygonRelative);
+        }
+        // Everything else (comments, groups, materials, ...) is ignored
+
+        line = lineEnd + 1;
+    }
+}
+
+struct ObjCornerHash
+{
+    size_t operator()(ObjCorner const& corner) const
+    {
+        size_t hash = 0;
+        for (std::int64_t index : corner.index)
+        {
+            hash ^= std::hash<std::int64_t>()(index) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+struct ObjCornerEqual
+{
+    bool operator()(ObjCorner const& a, ObjCorner const& b) const { return a.index == b.index; }
+};
+
+//
+// PLY
+//
+
+enum class PlyType
+{
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64
+};
+
+enum class PlyFormat
+{
+    Ascii,
+    BinaryLittleEndian,
+    BinaryBigEndian
+};
+
+struct PlyProperty
+{
+    std::string name;
+    PlyType     type;
+    bool        isList;
+    PlyType     countType;
+};
+
+struct PlyElement
+{
+    std::string              name;
+    size_t                   count;
+    std::vector<PlyProperty> properties;
+};
+
+PlyType parsePlyType(std::string const& name)
+{
+    if (name == "char" || name == "int8")
+        return PlyType::Int8;
+    if (name == "uchar" || name == "uint8")
+        return PlyType::UInt8;
+    if (name == "short" || name == "int16")
+        return PlyType::Int16;
+    if (name == "ushort" || name == "uint16")
+        return PlyType::UInt16;
+    if (name == "int" || name == "int32")
+        return PlyType::Int32;
+    if (name == "uint" || name == "uint32")
+        return PlyType::UInt32;
+    if (name == "float" || name == "float32")
+        return PlyType::Float32;
+    if (name == "double" || name == "float64")
+        return PlyType::Float64;
+
+    throw std::runtime_error("Unknown PLY property type " + name);
+}
+
+// Reads consecutive values from the body of a PLY file
+class PlyReader
+{
+public:
+    PlyReader(char const* begin, char const* end, PlyFormat format)
+        : m_p(begin)
+        , m_end(end)
+        , m_format(format)
+    {
+        std::uint16_t const probe = 1;
+        char                firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+        m_swap = (format == PlyFormat::BinaryBigEndian) == (firstByte == 1);
+    }
+
+    double read(PlyType type)
+    {
+        if (m_format == PlyFormat::Ascii)
+        {
+            while (m_p < m_end && std::isspace(static_cast<unsigned char>(*m_p)))
+            {
+                ++m_p;
+            }
+
+            double value;
+            if (m_p == m_end || !parseReal(m_p, m_end, value))
+            {
+                throw std::runtime_error("Invalid or missing value in PLY file.");
+            }
+            return value;
+        }
+
+        switch (type)
+        {
+        case PlyType::Int8: return readBinary<std::int8_t>();
+        case PlyType::UInt8: return readBinary<std::uint8_t>();
+        case PlyType::Int16: return readBinary<std::int16_t>();
+        case PlyType::UInt16: return readBinary<std::uint16_t>();
+        case PlyType::Int32: return readBinary<std::int32_t>();
+        case PlyType::UInt32: return readBinary<std::uint32_t>();
+        case PlyType::Float32: return readBinary<float>();
+        case PlyType::Float64: return readBinary<double>();
+        }
+
+        return 0.0;
+    }
+
+private:
+    template<typename T>
+    double readBinary()
+    {
+        if (static_cast<size_t>(m_end - m_p) < sizeof(T))
+        {
+            throw std::runtime_error("Unexpected end of PLY file.");
+        }
+
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, m_p, sizeof(T));
+        if (m_swap)
+        {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        m_p += sizeof(T);
+
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return static_cast<double>(value);
+    }
+
+    char const* m_p;
+    char const* m_end;
+    PlyFormat   m_format;
+    bool        m_swap;
+};
+
+} // namespace
+
+MeshData readObj(std::string const& path, unsigned int numThreads)
+{
+    MappedFile        file(path);
+    char const* const begin = file.data();
+    char const* const end   = begin + file.size();
+
+    // Split the file into chunks of whole lines
+    constexpr size_t const minChunkSize = 1 << 20;
+    size_t const           threadCount  = numThreads == 0 ? defaultThreadCount() : numThreads;
+    size_t const           chunkCount   = std::max<size_t>(1, std::min(4 * threadCount, file.size() / minChunkSize));
+
+    std::vector<char const*> boundaries = {begin};
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        char const* boundary = std::max(begin + file.size() * i / chunkCount, boundaries.back());
+        boundary             = std::find(boundary, end, '\n');
+        boundaries.push_back(boundary == end ? end : boundary + 1);
+    }
+    boundaries.push_back(end);
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    parallelFor(chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+        {
+            parseObjChunk(boundaries[i], boundaries[i + 1], chunks[i]);
+        }
+    }, static_cast<unsigned int>(threadCount));
+
+    // Offsets of the chunks in the global position/uv/normal lists
+    std::vector<std::array<std::int64_t, 3>> offsets(chunkCount + 1, {0, 0, 0});
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        offsets[i + 1][0] = offsets[i][0] + static_cast<std::int64_t>(chunks[i].positions.size() / 3);
+        offsets[i + 1][1] = offsets[i][1] + static_cast<std::int64_t>(chunks[i].uvs.size() / 2);
+        offsets[i + 1][2] = offsets[i][2] + static_cast<std::int64_t>(chunks[i].normals.size() / 3);
+    }
+    std::array<std::int64_t, 3> const totals = offsets[chunkCount];
+
+    // Resolve relative indices and validate all indices
+    std::array<std::atomic<bool>, 3> referenced = {false, false, false};
+    std::array<std::atomic<bool>, 3> identity   = {true, true, true}; // All corners have the same index for position and attribute
+    parallelFor(chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+        {
+            auto& chunk = chunks[i];
+            for (auto const& relative : chunk.relativeCorners)
+            {
+                chunk.corners[relative.corner].index[relative.attribute] += offsets[i][relative.attribute];
+            }
+
+            std::array<bool, 3> chunkReferenced = {false, false, false};
+            std::array<bool, 3> chunkIdentity   = {true, true, true};
+            for (auto const& corner : chunk.corners)
+            {
+                for (int attribute = 0; attribute < 3; ++attribute)
+                {
+                    std::int64_t const index = corner.index[attribute];
+                    if (index == noIndex && attribute > 0)
+                    {
+                        chunkIdentity[attribute] = false;
+                        continue;
+                    }
+
+                    if (index < 0 || index >= totals[attribute])
+                    {
+                        throw std::runtime_error("OBJ face references an element that does not exist.");
+                    }
+
+                    chunkReferenced[attribute] = true;
+                    chunkIdentity[attribute]   = chunkIdentity[attribute] && index == corner.index[0];
+                }
+            }
+
+            for (int attribute = 0; attribute < 3; ++attribute)
+            {
+                if (chunkReferenced[attribute])
+                    referenced[attribute] = true;
+                if (!chunkIdentity[attribute])
+                    identity[attribute] = false;
+            }
+        }
+    }, static_cast<unsigned int>(threadCount));
+
+    bool const hasUvs     = referenced[1];
+    bool const hasNormals = referenced[2];
+
+    size_t cornerCount = 0;
+    for (auto const& chunk : chunks)
+    {
+        cornerCount += chunk.corners.size();
+    }
+
+    MeshData mesh;
+    mesh.indices.reserve(cornerCount);
+
+    // If every corner uses the same index for all its attributes (e.g. files written by `xatlas.export`),
+    // the attribute lists can be used as vertex attributes directly. Otherwise, the vertices have to be split.
+    bool const direct = (!hasUvs || (identity[1] && totals[1] == totals[0])) && (!hasNormals || (identity[2] && totals[2] == totals[0]));
+    if (direct)
+    {
+        if (totals[0] > static_cast<std::int64_t>(std::numeric_limits<std::uint32_t>::max()))
+        {
+            throw std::runtime_error("OBJ file has too many vertices.");
+        }
+
+        for (auto& chunk : chunks)
+        {
+            mesh.positions.insert(mesh.positions.end(), chunk.positions.begin(), chunk.positions.end());
+            if (hasUvs)
+                mesh.uvs.insert(mesh.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+            if (hasNormals)
+                mesh.normals.insert(mesh.normals.end(), chunk.normals.begin(), chunk.normals.end());
+            for (auto const& corner : chunk.corners)
+            {
+                mesh.indices.push_back(static_cast<std::uint32_t>(corner.index[0]));
+            }
+
+            chunk = ObjChunk();
+        }
+
+        return mesh;
+    }
+
+    // Gather the attribute lists
+    std::vector<float> positions, uvs, normals;
+    for (auto& chunk : chunks)
+    {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    }
+
+    std::unordered_map<ObjCorner, std::uint32_t, ObjCornerHash, ObjCornerEqual> vertices;
+    vertices.reserve(static_cast<size_t>(totals[0]));
+    for (auto const& chunk : chunks)
+    {
+        for (auto const& corner : chunk.corners)
+        {
+            auto const inserted = vertices.emplace(corner, static_cast<std::uint32_t>(mesh.vertexCount()));
+            if (inserted.second)
+            {
+                if (mesh.vertexCount() == std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::runtime_error("OBJ file has too many vertices.");
+                }
+
+                auto const [p, t, n] = corner.index;
+                mesh.positions.insert(mesh.positions.end(), positions.begin() + 3 * p, positions.begin() + 3 * p + 3);
+                if (hasUvs)
+                {
+                    float const uv[2] = {t != noIndex ? uvs[2 * t + 0] : 0.f, t != noIndex ? uvs[2 * t + 1] : 0.f};
+                    mesh.uvs.insert(mesh.uvs.end(), uv, uv + 2);
+                }
+                if (hasNormals)
+                {
+                    float const normal[3] = {n != noIndex ? normals[3 * n + 0] : 0.f, n != noIndex ? normals[3 * n + 1] : 0.f, n != noIndex ? normals[3 * n + 2] : 0.f};
+                    mesh.normals.insert(mesh.normals.end(), normal, normal + 3);
+                }
+            }
+            mesh.indices.push_back(inserted.first->second);
+        }
+    }
+
+    return mesh;
+}
+
+MeshData readPly(std::string const& path)
+{
+    MappedFile        file(path);
+    char const* const begin = file.data();
+    char const* const end   = begin + file.size();
+
+    // Parse the header line by line
+    PlyFormat               format = PlyFormat::Ascii;
+    std::vector<PlyElement> elements;
+    char const*             body = nullptr;
+    bool                    first = true;
+    for (char const* line = begin; line < end && !body;)
+    {
+        char const* lineEnd = std::find(line, end, '\n');
+
+        std::istringstream stream(std::string(line, lineEnd));
+        std::string        keyword;
+        stream >> keyword;
+
+        if (first)
+        {
+            if (keyword != "ply")
+            {
+                throw std::runtime_error(path + " is not a PLY file.");
+            }
+            first = false;
+        }
+        else if (keyword == "format")
+        {
+            std::string name;
+            stream >> name;
+            if (name == "ascii")
+                format = PlyFormat::Ascii;
+            else if (name == "binary_little_endian")
+                format = PlyFormat::BinaryLittleEndian;
+            else if (name == "binary_big_endian")
+                format = PlyFormat::BinaryBigEndian;
+            else
+                throw std::runtime_error("Unknown PLY format " + name);
+        }
+        else if (keyword == "element")
+        {
+            PlyElement element;
+            stream >> element.name >> element.count;
+            elements.push_back(element);
+        }
+        else if (keyword == "property")
+        {
+            if (elements.empty())
+            {
+                throw std::runtime_error("PLY property without element.");
+            }
+
+            PlyProperty property;
+            std::string type;
+            stream >> type;
+            property.isList = type == "list";
+            if (property.isList)
+            {
+                std::string countType;
+                stream >> countType >> type;
+                property.countType = parsePlyType(countType);
+            }
+            property.type = parsePlyType(type);
+            stream >> property.name;
+            elements.back().properties.push_back(property);
+        }
+        else if (keyword == "end_header")
+        {
+            body = lineEnd == end ? end : lineEnd + 1;
+        }
+
+        line = lineEnd + 1;
+    }
+
+    if (!body)
+    {
+        throw std::runtime_error("PLY file without end_header.");
+    }
+
+    MeshData  mesh;
+    PlyReader reader(body, end, format);
+    size_t    vertexCount = 0;
+    for (auto const& element : elements)
+    {
+        if (element.name == "vertex")
+        {
+            // Destination of each property: position (0-2), normal (3-5), uv (6-7) or none (-1)
+            std::vector<int> targets;
+            std::array<bool, 8> present = {};
+            for (auto const& property : element.properties)
+            {
+                static std::vector<std::vector<char const*>> const names = {
+                    {"x"}, {"y"}, {"z"}, {"nx"}, {"ny"}, {"nz"},
+                    {"u", "s", "texture_u", "texture_s"}, {"v", "t", "texture_v", "texture_t"}};
+
+                int target = -1;
+                for (size_t i = 0; i < names.size() && target < 0; ++i)
+                {
+                    for (char const* name : names[i])
+                    {
+                        if (property.name == name && !property.isList)
+                        {
+                            target = static_cast<int>(i);
+                        }
+                    }
+                }
+
+                targets.push_back(target);
+                if (target >= 0)
+                {
+                    present[static_cast<size_t>(target)] = true;
+                }
+            }
+
+            if (!present[0] || !present[1] || !present[2])
+            {
+                throw std::runtime_error("PLY vertices without x, y and z.");
+            }
+            bool const hasNormals = present[3] && present[4] && present[5];
+            bool const hasUvs     = present[6] && present[7];
+
+            vertexCount = element.count;
+            mesh.positions.resize(3 * element.count);
+            mesh.normals.resize(hasNormals ? 3 * element.count : 0);
+            mesh.uvs.resize(hasUvs ? 2 * element.count : 0);
+
+            for (size_t v = 0; v < element.count; ++v)
+            {
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    auto const& property = element.properties[i];
+                    if (property.isList)
+                    {
+                        size_t const count = static_cast<size_t>(reader.read(property.countType));
+                        for (size_t k = 0; k < count; ++k)
+                        {
+                            reader.read(property.type);
+                        }
+                        continue;
+                    }
+
+                    float const value = static_cast<float>(reader.read(property.type));
+                    int const   target = targets[i];
+                    if (target >= 0 && target < 3)
+                    {
+                        mesh.positions[3 * v + static_cast<size_t>(target)] = value;
+                    }
+                    else if (target >= 3 && target < 6 && hasNormals)
+                    {
+                        mesh.normals[3 * v + static_cast<size_t>(target - 3)] = value;
+                    }
+                    else if (target >= 6 && hasUvs)
+                    {
+                        mesh.uvs[2 * v + static_cast<size_t>(target - 6)] = value;
+                    }
+                }
+            }
+        }
+        else if (element.name == "face")
+        {
+            std::vector<std::uint32_t> polygon;
+            for (size_t f = 0; f < element.count; ++f)
+            {
+                for (auto const& property : element.properties)
+                {
+                    bool const isIndices = property.isList && (property.name == "vertex_indices" || property.name == "vertex_index");
+                    size_t const count = property.isList ? static_cast<size_t>(reader.read(property.countType)) : 1;
+
+                    polygon.clear();
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        double const value = reader.read(property.type);
+                        if (isIndices)
+                        {
+                            // The vertices may follow the faces, so the indices are checked at the end
+                            if (value < 0 || value > static_cast<double>(std::numeric_limits<std::uint32_t>::max()))
+                            {
+                                throw std::runtime_error("PLY face references a vertex that does not exist.");
+                            }
+                            polygon.push_back(static_cast<std::uint32_t>(value));
+                        }
+                    }
+
+                    // Triangulate as a fan
+                    for (size_t k = 1; isIndices && k + 1 < polygon.size(); ++k)
+                    {
+                        mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[k], polygon[k + 1]});
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Skip other elements
+            for (size_t i = 0; i < element.count; ++i)
+            {
+                for (auto const& property : element.properties)
+                {
+                    size_t const count = property.isList ? static_cast<size_t>(reader.read(property.countType)) : 1;
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        reader.read(property.type);
+                    }
+                }
+            }
+        }
+    }
+
+    for (std::uint32_t const index : mesh.indices)
+    {
+        if (index >= vertexCount)
+        {
+            throw std::runtime_error("PLY face references a vertex that does not exist.");
+        }
+    }
+
+    return mesh;
+}
+
+MeshData readMesh(std::string const& path, unsigned int numThreads)
+{
+    if (hasExtension(path, ".obj"))
+    {
+        return readObj(path, numThreads);
+    }
+
+    if (hasExtension(path, ".ply"))
+    {
+        return readPly(path);
+    }
+
+    throw std::invalid_argument("Unsupported file format of " + path + " (expected .obj or .ply).");
+}
@@ -0,0 +1,51 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Triangle mesh with per-vertex attributes, as consumed by `xatlas::AddMesh`
+struct MeshData
+{
+    std::vector<float>         positions; // 3 per vertex
+    std::vector<std::uint32_t> indices;   // 3 per triangle
+    std::vector<float>         normals;   // 3 per vertex (empty if not available)
+    std::vector<float>         uvs;       // 2 per vertex (empty if not available)
+
+    std::size_t vertexCount() const { return positions.size() / 3; }
+};
+
+// Reads a Wavefront OBJ file from a memory mapping, parsing chunks of it on `numThreads` threads (0 uses all cores).
+// Polygons are triangulated as fans. Corners that combine a position with different uvs or normals become separate vertices.
+MeshData readObj(std::string const& path, unsigned int numThreads = 0);
+
+// Reads an ASCII or binary (little or big endian) PLY file from a memory mapping
+MeshData readPly(std::string const& path);
+
+// Reads an OBJ or PLY file, depending on the file extension
+MeshData readMesh(std::string const& path, unsigned int numThreads = 0);
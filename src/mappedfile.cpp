@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "mappedfile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::string const& path)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+{
+    // Paths are UTF-8 encoded
+    int const            length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::vector<wchar_t> widePath(static_cast<size_t>(length > 0 ? length : 1));
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), length);
+
+    m_file = CreateFileW(widePath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        throw std::invalid_argument("Cannot open path " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+    {
+        CloseHandle(m_file);
+        throw std::runtime_error("Cannot determine the size of " + path);
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+    {
+        m_data = static_cast<char const*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    if (!m_data)
+    {
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+        CloseHandle(m_file);
+        throw std::runtime_error("Cannot map " + path + " into memory");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(std::string const& path)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_file(-1)
+{
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        throw std::invalid_argument("Cannot open path " + path);
+    }
+
+    struct stat status;
+    if (fstat(m_file, &status) != 0)
+    {
+        close(m_file);
+        throw std::runtime_error("Cannot determine the size of " + path);
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+
+    // Empty files cannot be mapped
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        close(m_file);
+        throw std::runtime_error("Cannot map " + path + " into memory");
+    }
+    m_data = static_cast<char const*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    close(m_file);
+}
+
+#endif
@@ -0,0 +1,397 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "memory.hpp"
+
+#include <xatlas.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// Precedes every block handed to xatlas. The size doubles as alignment of the returned memory.
+struct alignas(16) BlockHeader
+{
+    MemoryTracker* tracker;
+    std::size_t    size; // Requested size, the highest bit marks blocks from a pool
+};
+
+constexpr std::size_t const pooledBit = std::size_t(1) << (sizeof(std::size_t) * 8 - 1);
+
+inline BlockHeader* headerOf(void* pointer)
+{
+    return static_cast<BlockHeader*>(pointer) - 1;
+}
+
+// Tracker of the allocations on the current thread
+thread_local MemoryTracker* t_tracker = nullptr;
+
+// The worker threads of xatlas take the tracker of the thread that created their atlas (see `xatlas::SetThreadContext`)
+void* captureTracker()
+{
+    return t_tracker;
+}
+
+void applyTracker(void* tracker)
+{
+    t_tracker = static_cast<MemoryTracker*>(tracker);
+}
+
+} // namespace
+
+// Serves small blocks from slabs with one free list per size class.
+// The slabs are only returned to the system when the pool is destroyed.
+class MemoryPool
+{
+public:
+    // Size classes of whole blocks (including the header) in multiples of the header size
+    static constexpr std::array<std::size_t, 8> const classSizes = {32, 48, 64, 96, 128, 192, 256, 512};
+
+    static constexpr std::size_t const maxBlockSize = classSizes.back();
+
+    MemoryPool() = default;
+
+    ~MemoryPool()
+    {
+        for (void* slab : m_slabs)
+        {
+            std::free(slab);
+        }
+    }
+
+    MemoryPool(MemoryPool const&)            = delete;
+    MemoryPool& operator=(MemoryPool const&) = delete;
+
+    void* allocate(std::size_t blockSize)
+    {
+        SizeClass& sizeClass = m_classes[classIndex(blockSize)];
+        SpinLock   lock(sizeClass.lock);
+
+        if (sizeClass.freeList)
+        {
+            FreeBlock* block    = sizeClass.freeList;
+            sizeClass.freeList = block->next;
+            return block;
+        }
+
+        std::size_t const size = classSizes[classIndex(blockSize)];
+        if (sizeClass.cursor + size > sizeClass.end)
+        {
+            char* slab = static_cast<char*>(std::malloc(slabSize));
+            if (!slab)
+            {
+                return nullptr;
+            }
+
+            {
+                std::lock_guard<std::mutex> slabsLock(m_slabsMutex);
+                m_slabs.push_back(slab);
+            }
+
+            sizeClass.cursor = slab;
+            sizeClass.end    = slab + slabSize;
+        }
+
+        void* block = sizeClass.cursor;
+        sizeClass.cursor += size;
+        return block;
+    }
+
+    void free(void* pointer, std::size_t blockSize)
+    {
+        SizeClass& sizeClass = m_classes[classIndex(blockSize)];
+        SpinLock   lock(sizeClass.lock);
+
+        FreeBlock* block    = static_cast<FreeBlock*>(pointer);
+        block->next        = sizeClass.freeList;
+        sizeClass.freeList = block;
+    }
+
+private:
+    static constexpr std::size_t const slabSize = 64 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct SizeClass
+    {
+        std::atomic_flag lock     = ATOMIC_FLAG_INIT;
+        FreeBlock*       freeList = nullptr;
+        char*            cursor   = nullptr;
+        char*            end      = nullptr;
+    };
+
+    // The critical sections are a few instructions, so spinning is cheaper than a mutex
+    class SpinLock
+    {
+    public:
+        explicit SpinLock(std::atomic_flag& flag)
+            : m_flag(flag)
+        {
+            while (m_flag.test_and_set(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        ~SpinLock()
+        {
+            m_flag.clear(std::memory_order_release);
+        }
+
+    private:
+        std::atomic_flag& m_flag;
+    };
+
+    static std::size_t classIndex(std::size_t blockSize)
+    {
+        return static_cast<std::size_t>(std::lower_bound(classSizes.begin(), classSizes.end(), blockSize) - classSizes.begin());
+    }
+
+    std::array<SizeClass, classSizes.size()> m_classes;
+    std::mutex                               m_slabsMutex;
+    std::vector<void*>                       m_slabs;
+};
+
+void MemoryTracker::Release::operator()(MemoryTracker* tracker) const
+{
+    tracker->setBudgetHandler(nullptr);
+    tracker->release();
+}
+
+MemoryTracker::Pointer MemoryTracker::create(bool pooled, std::optional<std::size_t> budget, bool accounted)
+{
+    return Pointer(new MemoryTracker(pooled, budget, accounted));
+}
+
+MemoryTracker::MemoryTracker(bool pooled, std::optional<std::size_t> budget, bool accounted)
+    : m_pool(pooled ? std::make_unique<MemoryPool>() : nullptr)
+    , m_budget(budget)
+    , m_accounted(accounted || pooled || budget)
+    , m_budgetSignalled(false)
+    , m_references(1)
+    , m_currentBytes(0)
+    , m_peakBytes(0)
+    , m_allocationCount(0)
+{
+}
+
+MemoryTracker::~MemoryTracker() = default;
+
+void MemoryTracker::setBudgetHandler(std::function<void()> handler)
+{
+    m_budgetHandler = std::move(handler);
+}
+
+void MemoryTracker::rearm()
+{
+    m_budgetSignalled = false;
+}
+
+void* MemoryTracker::allocate(std::size_t size, MemoryTracker* tracker)
+{
+    if (size > ~pooledBit - sizeof(BlockHeader))
+    {
+        return nullptr;
+    }
+
+    std::size_t const blockSize = size + sizeof(BlockHeader);
+
+    BlockHeader* header;
+    if (tracker && tracker->m_pool && blockSize <= MemoryPool::maxBlockSize)
+    {
+        header = static_cast<BlockHeader*>(tracker->m_pool->allocate(blockSize));
+        if (header)
+            header->size = size | pooledBit;
+    }
+    else
+    {
+        header = static_cast<BlockHeader*>(std::malloc(blockSize));
+        if (header)
+            header->size = size;
+    }
+
+    if (!header)
+    {
+        return nullptr;
+    }
+
+    header->tracker = tracker;
+    if (tracker)
+    {
+        tracker->onAllocate(size);
+    }
+
+    return header + 1;
+}
+
+void* MemoryTracker::reallocate(void* pointer, std::size_t size)
+{
+    if (!pointer)
+    {
+        if (size == 0)
+        {
+            return nullptr;
+        }
+
+        return allocate(size, t_tracker && t_tracker->m_accounted ? t_tracker : nullptr);
+    }
+
+    if (size == 0)
+    {
+        free(pointer);
+        return nullptr;
+    }
+
+    // Keep the block attributed to its tracker
+    BlockHeader*      header  = headerOf(pointer);
+    std::size_t const oldSize = header->size & ~pooledBit;
+    MemoryTracker*    tracker = header->tracker;
+
+    // Blocks from the heap are resized in place where possible
+    if (!(header->size & pooledBit))
+    {
+        if (size > ~pooledBit - sizeof(BlockHeader))
+        {
+            return nullptr;
+        }
+
+        BlockHeader* resized = static_cast<BlockHeader*>(std::realloc(header, size + sizeof(BlockHeader)));
+        if (!resized)
+        {
+            return nullptr;
+        }
+
+        resized->size = size;
+        if (tracker)
+        {
+            tracker->onResize(oldSize, size);
+        }
+
+        return resized + 1;
+    }
+
+    void* result = allocate(size, tracker);
+    if (result)
+    {
+        std::memcpy(result, pointer, std::min(oldSize, size));
+        free(pointer);
+    }
+
+    return result;
+}
+
+void MemoryTracker::free(void* pointer)
+{
+    if (!pointer)
+    {
+        return;
+    }
+
+    BlockHeader*      header  = headerOf(pointer);
+    MemoryTracker*    tracker = header->tracker;
+    std::size_t const size    = header->size & ~pooledBit;
+
+    if (header->size & pooledBit)
+    {
+        tracker->m_pool->free(header, size + sizeof(BlockHeader));
+    }
+    else
+    {
+        std::free(header);
+    }
+
+    if (tracker)
+    {
+        tracker->onFree(size);
+    }
+}
+
+void MemoryTracker::onAllocate(std::size_t size)
+{
+    m_references.fetch_add(1, std::memory_order_relaxed);
+    m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    onResize(0, size);
+}
+
+void MemoryTracker::onResize(std::size_t oldSize, std::size_t newSize)
+{
+    if (newSize <= oldSize)
+    {
+        m_currentBytes.fetch_sub(oldSize - newSize, std::memory_order_relaxed);
+        return;
+    }
+
+    std::size_t const growth  = newSize - oldSize;
+    std::size_t const current = m_currentBytes.fetch_add(growth, std::memory_order_relaxed) + growth;
+    std::size_t       peak    = m_peakBytes.load(std::memory_order_relaxed);
+    while (current > peak && !m_peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+
+    if (m_budget && current > *m_budget && !m_budgetSignalled.exchange(true) && m_budgetHandler)
+    {
+        m_budgetHandler();
+    }
+}
+
+void MemoryTracker::onFree(std::size_t size)
+{
+    m_currentBytes.fetch_sub(size, std::memory_order_relaxed);
+    release();
+}
+
+void MemoryTracker::release()
+{
+    if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete this;
+    }
+}
+
+MemoryScope::MemoryScope(MemoryTracker* tracker)
+    : m_previous(t_tracker)
+{
+    t_tracker = tracker;
+}
+
+MemoryScope::~MemoryScope()
+{
+    t_tracker = m_previous;
+}
+
+void installAllocator()
+{
+    xatlas::SetAlloc(&MemoryTracker::reallocate, &MemoryTracker::free);
+    xatlas::SetThreadContext(&captureTracker, &applyTracker);
+}
@@ -0,0 +1,119 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+// Raised when an operation exceeds the memory budget of its atlas
+class MemoryBudgetError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class MemoryPool;
+
+// Accounts the memory that xatlas allocates for one atlas and optionally serves its small allocations from a pool.
+// Allocations are attributed to the tracker of the allocating thread (see `MemoryScope`). The worker threads of xatlas
+// take the tracker of the thread that created their atlas. Trackers without pool, budget or `accounted` flag only keep
+// the allocations of their threads apart and cost nothing beyond the block header.
+class MemoryTracker
+{
+public:
+    struct Release
+    {
+        void operator()(MemoryTracker* tracker) const;
+    };
+
+    // Owning reference. The tracker itself lives until all memory attributed to it is freed.
+    using Pointer = std::unique_ptr<MemoryTracker, Release>;
+
+    // `budget` is the number of bytes above which the budget handler is called. Pooled trackers and trackers with a
+    // budget are always accounted.
+    static Pointer create(bool pooled = false, std::optional<std::size_t> budget = std::nullopt, bool accounted = false);
+
+    // The handler is called (at most once until `rearm`) on the allocating thread when the budget is exceeded
+    void setBudgetHandler(std::function<void()> handler);
+
+    // Allows the budget handler to be called again, e.g. at the start of an operation
+    void rearm();
+
+    std::size_t                currentBytes() const { return m_currentBytes; }
+    std::size_t                peakBytes() const { return m_peakBytes; }
+    std::size_t                allocationCount() const { return m_allocationCount; }
+    std::optional<std::size_t> budget() const { return m_budget; }
+    bool                       pooled() const { return static_cast<bool>(m_pool); }
+    bool                       accounted() const { return m_accounted; }
+
+private:
+    friend void installAllocator();
+
+    MemoryTracker(bool pooled, std::optional<std::size_t> budget, bool accounted);
+    ~MemoryTracker();
+
+    static void* reallocate(void* pointer, std::size_t size);
+    static void  free(void* pointer);
+
+    static void* allocate(std::size_t size, MemoryTracker* tracker);
+
+    void onAllocate(std::size_t size);
+    void onResize(std::size_t oldSize, std::size_t newSize);
+    void onFree(std::size_t size);
+    void release();
+
+    std::unique_ptr<MemoryPool> m_pool;
+    std::optional<std::size_t>  m_budget;
+    bool                        m_accounted;
+    std::function<void()>       m_budgetHandler;
+    std::atomic<bool>           m_budgetSignalled;
+
+    std::atomic<std::size_t> m_references; // Owner and live allocations
+    std::atomic<std::size_t> m_currentBytes;
+    std::atomic<std::size_t> m_peakBytes;
+    std::atomic<std::size_t> m_allocationCount;
+};
+
+// Attributes the allocations of the current thread to a tracker for the lifetime of the scope
+class MemoryScope
+{
+public:
+    explicit MemoryScope(MemoryTracker* tracker);
+    ~MemoryScope();
+
+    MemoryScope(MemoryScope const&)            = delete;
+    MemoryScope& operator=(MemoryScope const&) = delete;
+
+private:
+    MemoryTracker* m_previous;
+};
+
+// Routes all allocations of xatlas through the trackers (see `xatlas::SetAlloc` and `xatlas::SetThreadContext`).
+// Must be called before xatlas allocates any memory.
+void installAllocator();
@@ -22,16 +22,26 @@
  * SOFTWARE.
  */
 
+#include "async.hpp"
 #include "atlas.hpp"
+#include "cache.hpp"
+#include "format.hpp"
+#include "io.hpp"
+#include "memory.hpp"
 #include "options.hpp"
+#include "progress.hpp"
+#include "threading.hpp"
 #include "utils.hpp"
+#include "weld.hpp"
 
+#include <algorithm>
 #include <cstdint>
-#include <fstream>
-#include <iostream>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -44,117 +54,340 @@ namespace py = pybind11;
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
 
-auto parametrize(ContiguousArray<float> const&         positions,
-                 ContiguousArray<std::uint32_t> const& indices,
-                 std::optional<ContiguousArray<float>> normals = std::nullopt,
-                 std::optional<ContiguousArray<float>> uvs     = std::nullopt)
+struct AtlasDeleter
 {
-    Atlas atlas;
-    atlas.addMesh(positions, indices, normals, uvs);
-    atlas.generate();
-    return atlas.getMesh(0);
-}
+    void operator()(xatlas::Atlas* atlas) const { xatlas::Destroy(atlas); }
+};
 
-void exportObj(std::string const&                            path,
-               ContiguousArray<float> const&                 positions,
-               std::optional<ContiguousArray<std::uint32_t>> indices = std::nullopt,
-               std::optional<ContiguousArray<float>>         uvs     = std::nullopt,
-               std::optional<ContiguousArray<float>>         normals = std::nullopt)
+py::object parametrize(py::object const&           positions,
+                       py::object const&           indices,
+                       std::optional<py::object>   normals = std::nullopt,
+                       std::optional<py::object>   uvs     = std::nullopt,
+                       Cache*                      cache   = nullptr,
+                       std::optional<WeldOptions>  weld    = std::nullopt,
+                       std::optional<OutputFormat> format  = std::nullopt)
 {
-    // Perform sanity checks on the inputs
-    checkShape("Position", positions, 3);
-    if (indices)
+    if (format)
     {
-        checkShape("Index", *indices, 3);
+        format->validate();
     }
-    if (normals)
+
+    std::uint64_t key = 0;
+
+    // A cache hit does not need an atlas at all
+    if (cache)
     {
-        checkShape("Normal", *normals, 3, positions.shape(0));
+        MeshInput const input(positions, indices, normals, uvs);
+
+        std::unique_ptr<RestoredAtlas> restored;
+        {
+            py::gil_scoped_release release;
+
+            Hasher hasher;
+            input.hash(hasher);
+            if (weld)
+            {
+                weld->hash(hasher);
+            }
+            key      = Cache::key(hasher, xatlas::ChartOptions(), xatlas::PackOptions());
+            restored = cache->load(key);
+        }
+
+        if (restored && restored->atlas().meshCount == 1)
+        {
+            return format ? py::object(encodeMesh(restored->atlas(), 0, nullptr, *format)) : py::cast(Atlas::meshToArrays(restored->atlas(), 0));
+        }
     }
-    if (uvs)
+
+    Atlas atlas;
+    atlas.addMesh(positions, indices, normals, uvs, std::nullopt, weld);
+    atlas.generate();
+
+    if (cache)
     {
-        checkShape("Texture coordinates", *uvs, 2, positions.shape(0));
+        py::gil_scoped_release release;
+        cache->store(key, atlas.output(), atlas.vertexRemaps());
     }
 
-    std::ofstream file(path);
+    return atlas.getMesh(0, format);
+}
 
-    if (!file.is_open())
+py::object parametrizeAsync(py::object const&           positions,
+                            py::object const&           indices,
+                            std::optional<py::object>   normals = std::nullopt,
+                            std::optional<py::object>   uvs     = std::nullopt,
+                            Cache*                      cache   = nullptr,
+                            std::optional<WeldOptions>  weld    = std::nullopt,
+                            std::optional<OutputFormat> format  = std::nullopt)
+{
+    struct State
     {
-        throw std::invalid_argument("Cannot open path " + path);
-    }
+        // The input keeps the (possibly converted) arrays alive while the job runs
+        std::optional<MeshInput>                     input;
+        MemoryTracker::Pointer                       memory;
+        std::unique_ptr<xatlas::Atlas, AtlasDeleter> atlas;
+        std::unique_ptr<RestoredAtlas>               restored;
+        VertexRemaps                                 remaps; // Original vertices of the welded mesh
+    };
 
-    // Write the vertex positions
-    for (py::ssize_t v = 0; v < positions.shape(0); ++v)
+    // Validate the inputs before starting the job
+    auto state = std::make_shared<State>();
+    state->input.emplace(positions, indices, normals, uvs);
+    if (format)
     {
-        float const* position = positions.data(v, 0);
-        file << "v " << position[0] << " " << position[1] << " " << position[2] << std::endl;
+        format->validate();
     }
 
-    // Write the vertex normals
-    if (normals)
+    py::object const cacheObject = cache ? py::cast(cache) : py::none();
+
+    return AsyncJob::submit(
+        [state, cache, weld]() {
+            std::uint64_t key = 0;
+            if (cache)
+            {
+                Hasher hasher;
+                state->input->hash(hasher);
+                if (weld)
+                {
+                    weld->hash(hasher);
+                }
+                key             = Cache::key(hasher, xatlas::ChartOptions(), xatlas::PackOptions());
+                state->restored = cache->load(key);
+                if (state->restored && state->restored->atlas().meshCount == 1)
+                {
+                    return;
+                }
+                state->restored.reset();
+            }
+
+            state->memory = MemoryTracker::create();
+            MemoryScope memory(state->memory.get());
+
+            // The running jobs share the threads, as in `parametrize_batch`
+            state->atlas.reset(xatlas::Create(AsyncJob::threadShare()));
+
+            xatlas::AddMeshError error;
+            if (weld)
+            {
+                WeldedMesh welded = weldMesh(state->input->meshDecl(), *weld);
+                error             = xatlas::AddMesh(state->atlas.get(), welded.meshDecl());
+                state->remaps.push_back(std::move(welded.remap));
+            }
+            else
+            {
+                error = xatlas::AddMesh(state->atlas.get(), state->input->meshDecl());
+            }
+            if (error != xatlas::AddMeshError::Success)
+            {
+                throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
+            }
+
+            xatlas::Generate(state->atlas.get());
+            if (state->atlas->meshCount == 0)
+            {
+                throw std::runtime_error("Generating the atlas failed.");
+            }
+
+            if (cache)
+            {
+                cache->store(key, *state->atlas, &state->remaps);
+            }
+        },
+        [state, cacheObject, format]() -> py::object {
+            xatlas::Atlas const* atlas = state->restored ? &state->restored->atlas() : state->atlas && state->atlas->meshCount > 0 ? state->atlas.get() : nullptr;
+            if (atlas)
+            {
+                // A restored atlas already refers to the original vertices
+                std::vector<std::uint32_t> const* remap = !state->restored && !state->remaps.empty() ? &state->remaps[0] : nullptr;
+                return format ? py::object(encodeMesh(*atlas, 0, remap, *format)) : py::cast(Atlas::meshToArrays(*atlas, 0, remap));
+            }
+
+            // The job failed
+            return py::none();
+        });
+}
+
+using BatchResult = std::tuple<
+    std::vector<std::optional<MeshResult>>, // Results in input order (`None` if failed)
+    std::vector<std::optional<std::string>> // Errors in input order (`None` if succeeded)
+>;
+
+BatchResult parametrizeBatch(std::vector<py::sequence> const& meshes,
+                             xatlas::ChartOptions const&      chartOptions = xatlas::ChartOptions(),
+                             xatlas::PackOptions const&       packOptions  = xatlas::PackOptions(),
+                             unsigned int                     numThreads   = 0,
+                             std::optional<WeldOptions>       weld         = std::nullopt)
+{
+    struct Item
     {
-        for (py::ssize_t v = 0; v < (*normals).shape(0); ++v)
-        {
-            float const* normal = (*normals).data(v, 0);
-            file << "vn " << normal[0] << " " << normal[1] << " " << normal[2] << std::endl;
-        }
-    }
+        // The input keeps the (possibly converted) arrays alive while the GIL is released
+        std::optional<MeshInput>                     input;
+        xatlas::MeshDecl                             meshDecl;
+        MemoryTracker::Pointer                       memory; // Keeps the allocations of concurrent atlases apart
+        std::unique_ptr<xatlas::Atlas, AtlasDeleter> atlas;
+        std::vector<std::uint32_t>                   remap; // Original vertices of the welded mesh
+        std::optional<std::string>                   error;
+    };
 
-    // Write the vertex uv coordinates
-    if (uvs)
+    // Convert and validate the inputs while holding the GIL.
+    // Invalid meshes are reported but do not abort the batch.
+    std::vector<Item> items(meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i)
     {
-        for (py::ssize_t v = 0; v < (*uvs).shape(0); ++v)
+        auto const& mesh = meshes[i];
+        auto&       item = items[i];
+        try
+        {
+            if (mesh.size() < 2 || mesh.size() > 4)
+            {
+                throw std::invalid_argument("Mesh expected to be a tuple (positions, indices[, normals[, uvs]]).");
+            }
+
+            std::optional<py::object> normals;
+            if (mesh.size() > 2 && !mesh[2].is_none())
+            {
+                normals = mesh[2];
+            }
+            std::optional<py::object> uvs;
+            if (mesh.size() > 3 && !mesh[3].is_none())
+            {
+                uvs = mesh[3];
+            }
+
+            item.input.emplace(mesh[0], mesh[1], normals, uvs);
+            item.meshDecl = item.input->meshDecl();
+        }
+        catch (std::exception const& e)
         {
-            float const* uv = (*uvs).data(v, 0);
-            file << "vt " << uv[0] << " " << uv[1] << std::endl;
+            item.error = e.what();
         }
     }
 
-    if (indices)
+    // Generate an independent atlas per mesh. The meshes are spread over the threads, so the task scheduler of each
+    // atlas only gets the threads left over by a short batch (usually it runs on its pool worker alone).
+    unsigned int const threadCount = numThreads == 0 ? defaultThreadCount() : numThreads;
+    unsigned int const itemThreads = static_cast<unsigned int>(std::max<size_t>(1, threadCount / std::max<size_t>(1, items.size())));
     {
-        std::function<std::string(size_t)> formatFace = [](size_t index) { return std::to_string(index); };
+        py::gil_scoped_release release;
 
-        if (normals && uvs)
-        {
-            formatFace = [](size_t index) { return std::to_string(index) + "/" + std::to_string(index) + "/" + std::to_string(index); };
-        }
-        else if (normals)
+        parallelFor(items.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto& item = items[i];
+                if (item.error)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    item.memory = MemoryTracker::create();
+                    MemoryScope memory(item.memory.get());
+
+                    item.atlas.reset(xatlas::Create(itemThreads));
+
+                    // Each mesh is welded on its own worker
+                    xatlas::AddMeshError error;
+                    if (weld)
+                    {
+                        WeldedMesh welded = weldMesh(item.meshDecl, *weld, 1);
+                        error             = xatlas::AddMesh(item.atlas.get(), welded.meshDecl());
+                        item.remap        = std::move(welded.remap);
+                    }
+                    else
+                    {
+                        error = xatlas::AddMesh(item.atlas.get(), item.meshDecl);
+                    }
+                    if (error != xatlas::AddMeshError::Success)
+                    {
+                        throw std::runtime_error("Adding mesh failed: " + std::string(xatlas::StringForEnum(error)));
+                    }
+
+                    xatlas::Generate(item.atlas.get(), chartOptions, packOptions);
+                    if (item.atlas->meshCount == 0)
+                    {
+                        throw std::runtime_error("Generating the atlas failed.");
+                    }
+                }
+                catch (std::exception const& e)
+                {
+                    item.error = e.what();
+                    item.atlas.reset();
+                }
+            }
+        }, numThreads);
+    }
+
+    // Convert the results while holding the GIL
+    BatchResult result;
+    auto& [meshResults, errors] = result;
+    meshResults.reserve(items.size());
+    errors.reserve(items.size());
+    for (auto& item : items)
+    {
+        if (item.atlas)
         {
-            formatFace = [](size_t index) { return std::to_string(index) + "//" + std::to_string(index); };
+            meshResults.push_back(Atlas::meshToArrays(*item.atlas, 0, item.remap.empty() ? nullptr : &item.remap));
+            item.atlas.reset();
         }
-        else if (uvs)
+        else
         {
-            formatFace = [](size_t index) { return std::to_string(index) + "/" + std::to_string(index); };
+            meshResults.push_back(std::nullopt);
         }
 
-        // Write the faces
-        for (py::ssize_t f = 0; f < (*indices).shape(0); ++f)
-        {
-            std::uint32_t const* face = (*indices).data(f, 0);
-
-            file << "f " << formatFace(static_cast<size_t>(face[0]) + 1) << " " << formatFace(static_cast<size_t>(face[1]) + 1) << " " << formatFace(static_cast<size_t>(face[2]) + 1) << std::endl;
-        }
+        errors.push_back(item.error);
     }
+
+    return result;
 }
 
 PYBIND11_MODULE(xatlas, m)
 {
+    // The memory of xatlas is accounted per atlas (only for atlases that ask for it, see MemoryTracker)
+    installAllocator();
+
     py::enum_<xatlas::ChartType>(m, "ChartType")
     .value("Planar", xatlas::ChartType::Planar)
     .value("Ortho", xatlas::ChartType::Ortho)
     .value("LSCM", xatlas::ChartType::LSCM)
     .value("Piecewise", xatlas::ChartType::Piecewise)
     .value("Invalid", xatlas::ChartType::Invalid);
+
+    py::enum_<xatlas::ProgressCategory>(m, "ProgressCategory")
+    .value("AddMesh", xatlas::ProgressCategory::AddMesh)
+    .value("ComputeCharts", xatlas::ProgressCategory::ComputeCharts)
+    .value("PackCharts", xatlas::ProgressCategory::PackCharts)
+    .value("BuildOutputMeshes", xatlas::ProgressCategory::BuildOutputMeshes);
+
+    py::register_exception<CancelledError>(m, "CancelledError", PyExc_RuntimeError);
+    py::register_exception<MemoryBudgetError>(m, "MemoryBudgetError", PyExc_MemoryError);
     
     ChartOptions::bind(m);
     PackOptions::bind(m);
+    WeldOptions::bind(m);
+    OutputFormat::bind(m);
+    AsyncJob::bind(m);
+    Cache::bind(m);
     Atlas::bind(m);
 
     // Convenience functions
-    m.def("parametrize", &parametrize, py::arg("positions"), py::arg("indices"), py::arg("normals") = std::nullopt, py::arg("uvs") = std::nullopt);
+    m.def("parametrize", &parametrize, py::arg("positions"), py::arg("indices"), py::arg("normals") = std::nullopt, py::arg("uvs") = std::nullopt, py::arg("cache") = nullptr, py::arg("weld") = std::nullopt, py::arg("format") = std::nullopt);
+    m.def("parametrize_async", &parametrizeAsync, py::arg("positions"), py::arg("indices"), py::arg("normals") = std::nullopt, py::arg("uvs") = std::nullopt, py::arg("cache") = nullptr, py::arg("weld") = std::nullopt, py::arg("format") = std::nullopt);
+    m.def("parametrize_batch", &parametrizeBatch, py::arg("meshes"), py::arg("chart_options") = xatlas::ChartOptions(), py::arg("pack_options") = xatlas::PackOptions(), py::arg("num_threads") = 0, py::arg("weld") = std::nullopt);
+
+    // Threading
+    m.def("set_thread_count", &setThreadCount, py::arg("thread_count"), py::call_guard<py::gil_scoped_release>());
+    m.def("get_thread_count", &defaultThreadCount);
+#ifdef XATLAS_PYTHON_MULTITHREADED
+    m.attr("multithreaded") = true;
+#else
+    m.attr("multithreaded") = false;
+#endif
 
     // I/O functions
-    m.def("export", &exportObj, py::arg("path"), py::arg("positions"), py::arg("indices") = std::nullopt, py::arg("uvs") = std::nullopt, py::arg("normals") = std::nullopt);
+    m.def("export", &exportObj, py::arg("path"), py::arg("positions"), py::arg("indices") = std::nullopt, py::arg("uvs") = std::nullopt, py::arg("normals") = std::nullopt, py::arg("num_threads") = 0);
+    m.def("load_obj", &loadObj, py::arg("path"), py::arg("num_threads") = 0);
+    m.def("load_ply", &loadPly, py::arg("path"));
 
 #ifdef VERSION_INFO
     m.attr("__version__") = MACRO_STRINGIFY(VERSION_INFO);
@@ -0,0 +1,181 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "progress.hpp"
+
+namespace py = pybind11;
+
+// Minimum time between two reports of the same stage
+constexpr std::chrono::milliseconds const reportInterval{100};
+
+ProgressMonitor::ProgressMonitor()
+    : m_timeline(nullptr)
+    , m_hasCallback(false)
+    , m_cancelled(false)
+    , m_hasDeadline(false)
+    , m_deadlineReached(false)
+{
+}
+
+void ProgressMonitor::attach(xatlas::Atlas* atlas)
+{
+    xatlas::SetProgressCallback(atlas, &ProgressMonitor::progressFunc, this);
+}
+
+void ProgressMonitor::setTimeline(Timeline* timeline)
+{
+    m_timeline = timeline;
+}
+
+void ProgressMonitor::setCallback(std::optional<py::function> callback)
+{
+    // Reset the throttling, so the first update of the next operation is always reported
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastCategory.reset();
+    }
+
+    m_callback    = callback ? *callback : py::function();
+    m_hasCallback = static_cast<bool>(callback);
+}
+
+void ProgressMonitor::cancel(std::exception_ptr reason)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_reason)
+        {
+            m_reason = reason;
+        }
+    }
+
+    m_cancelled = true;
+}
+
+void ProgressMonitor::setDeadline(std::optional<std::chrono::steady_clock::time_point> deadline)
+{
+    m_deadline        = deadline.value_or(std::chrono::steady_clock::time_point());
+    m_hasDeadline     = deadline.has_value();
+    m_deadlineReached = false;
+}
+
+void ProgressMonitor::throwIfCancelled()
+{
+    if (!m_cancelled.exchange(false))
+    {
+        return;
+    }
+
+    std::exception_ptr reason;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(reason, m_reason);
+    }
+
+    if (m_error)
+    {
+        py::error_already_set error = std::move(*m_error);
+        m_error.reset();
+        throw error;
+    }
+
+    if (reason)
+    {
+        std::rethrow_exception(reason);
+    }
+
+    throw CancelledError("The operation was cancelled by the progress callback.");
+}
+
+bool ProgressMonitor::progressFunc(xatlas::ProgressCategory category, int progress, void* userData)
+{
+    return static_cast<ProgressMonitor*>(userData)->update(category, progress);
+}
+
+bool ProgressMonitor::update(xatlas::ProgressCategory category, int progress)
+{
+    if (m_cancelled)
+    {
+        return false;
+    }
+
+    if (m_hasDeadline && (m_deadlineReached || std::chrono::steady_clock::now() >= m_deadline))
+    {
+        m_deadlineReached = true;
+        return false;
+    }
+
+    if (m_timeline)
+    {
+        m_timeline->stage(category, progress);
+    }
+
+    if (!m_hasCallback)
+    {
+        return true;
+    }
+
+    // Always report the start and the end of a stage, throttle everything in between
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto const now = std::chrono::steady_clock::now();
+        if (m_lastCategory == category && progress < 100 && now - m_lastReport < reportInterval)
+        {
+            return true;
+        }
+
+        m_lastCategory = category;
+        m_lastReport   = now;
+    }
+
+    py::gil_scoped_acquire acquire;
+
+    // The callable may have been removed while waiting for the GIL
+    if (!m_hasCallback)
+    {
+        return true;
+    }
+
+    try
+    {
+        py::object result = m_callback(category, progress);
+
+        // Only an explicit `False` cancels the operation, so callables without return value are fine
+        if (!result.is_none() && !py::bool_(result))
+        {
+            m_cancelled = true;
+        }
+    }
+    catch (py::error_already_set& e)
+    {
+        if (!m_error)
+        {
+            m_error = std::move(e);
+        }
+        m_cancelled = true;
+    }
+
+    return !m_cancelled;
+}
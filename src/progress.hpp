@@ -0,0 +1,99 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "timeline.hpp"
+
+#include <pybind11/pybind11.h>
+
+#include <xatlas.h>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+// Raised when a progress callback cancels an operation by returning False
+class CancelledError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Forwards the progress of xatlas operations to an (optional) Python callable.
+// The callable is throttled and the GIL is only acquired when it is actually invoked,
+// which may happen from the worker threads of xatlas.
+class ProgressMonitor
+{
+public:
+    ProgressMonitor();
+
+    // Installs the monitor as progress callback of the atlas.
+    // Must happen before any mesh is added, because xatlas captures the callback per operation.
+    void attach(xatlas::Atlas* atlas);
+
+    // Records the stages reported by xatlas in the timeline (if not null)
+    void setTimeline(Timeline* timeline);
+
+    // Sets the callable for subsequent operations (requires the GIL)
+    void setCallback(std::optional<pybind11::function> callback);
+
+    // Cancels the running operation from any thread. `throwIfCancelled` rethrows the (first) reason.
+    void cancel(std::exception_ptr reason);
+
+    // Whether the running operation has been cancelled (from any thread)
+    bool cancelled() const { return m_cancelled; }
+
+    // Stops subsequent operations at the first progress update after `deadline` (none to disable).
+    // Unlike a cancellation, this is not an error and is reported by `deadlineReached` instead.
+    void setDeadline(std::optional<std::chrono::steady_clock::time_point> deadline);
+
+    // Whether an operation has been stopped at the deadline since it was set
+    bool deadlineReached() const { return m_deadlineReached; }
+
+    // Throws if the last operation was cancelled and resets the cancellation state (requires the GIL)
+    void throwIfCancelled();
+
+private:
+    static bool progressFunc(xatlas::ProgressCategory category, int progress, void* userData);
+
+    bool update(xatlas::ProgressCategory category, int progress);
+
+    Timeline*                                  m_timeline;
+    pybind11::function                         m_callback;
+    std::atomic<bool>                          m_hasCallback;
+    std::atomic<bool>                          m_cancelled;
+    std::atomic<bool>                          m_hasDeadline;
+    std::atomic<bool>                          m_deadlineReached;
+    std::chrono::steady_clock::time_point      m_deadline; // Only changed between operations
+    std::optional<pybind11::error_already_set> m_error; // Exception raised by the callable
+
+    std::mutex                              m_mutex; // Guards the throttling state and the cancellation reason
+    std::optional<xatlas::ProgressCategory> m_lastCategory;
+    std::chrono::steady_clock::time_point   m_lastReport;
+    std::exception_ptr                      m_reason; // Reason of a cancellation through `cancel`
+};
@@ -0,0 +1,340 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr char const          magic[8]  = {'X', 'A', 'T', 'L', 'A', 'S', 'P', 'Y'};
+constexpr std::uint32_t const version   = 1;
+constexpr std::uint32_t const byteOrder = 0x01020304;
+constexpr std::uint32_t const hasImage  = 1;
+
+static_assert(sizeof(xatlas::Vertex) == 5 * sizeof(std::uint32_t), "Unexpected layout of xatlas::Vertex");
+
+std::size_t imageSize(xatlas::Atlas const& atlas)
+{
+    return static_cast<std::size_t>(atlas.width) * atlas.height * atlas.atlasCount;
+}
+
+class Writer
+{
+public:
+    explicit Writer(char* out)
+        : m_out(out)
+    {
+    }
+
+    template<typename T>
+    void write(T const* values, std::size_t count)
+    {
+        if (count > 0)
+        {
+            std::memcpy(m_out, values, sizeof(T) * count);
+            m_out += sizeof(T) * count;
+        }
+    }
+
+    void write(std::uint32_t value) { write(&value, 1); }
+
+private:
+    char* m_out;
+};
+
+// Reads consecutive arrays from the serialized data and checks that they are within bounds
+class Reader
+{
+public:
+    Reader(char const* data, std::size_t size)
+        : m_data(data)
+        , m_end(data + size)
+    {
+    }
+
+    template<typename T>
+    T const* read(std::size_t count)
+    {
+        if (count > static_cast<std::size_t>(m_end - m_data) / sizeof(T))
+        {
+            throw std::runtime_error("Invalid or truncated atlas data.");
+        }
+
+        T const* values = reinterpret_cast<T const*>(m_data);
+        m_data += sizeof(T) * count;
+        return values;
+    }
+
+    std::uint32_t readUInt()
+    {
+        std::uint32_t value;
+        std::memcpy(&value, read<std::uint32_t>(1), sizeof(value));
+        return value;
+    }
+
+private:
+    char const* m_data;
+    char const* m_end;
+};
+
+} // namespace
+
+std::size_t serializedSize(xatlas::Atlas const& atlas, bool includeImage)
+{
+    std::size_t size = sizeof(magic) + 8 * sizeof(std::uint32_t) + sizeof(float) * (1 + atlas.atlasCount);
+    for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+    {
+        auto const& mesh = atlas.meshes[m];
+        size += 3 * sizeof(std::uint32_t) + sizeof(xatlas::Vertex) * mesh.vertexCount + sizeof(std::uint32_t) * mesh.indexCount;
+        for (std::uint32_t c = 0; c < mesh.chartCount; ++c)
+        {
+            size += sizeof(std::uint32_t) * (4 + mesh.chartArray[c].faceCount);
+        }
+    }
+
+    if (includeImage && atlas.image)
+    {
+        size += sizeof(std::uint32_t) * imageSize(atlas);
+    }
+
+    return size;
+}
+
+void serializeAtlas(xatlas::Atlas const& atlas, bool includeImage, char* out, VertexRemaps const* remaps)
+{
+    bool const image = includeImage && atlas.image;
+
+    Writer writer(out);
+    writer.write(magic, sizeof(magic));
+    writer.write(version);
+    writer.write(byteOrder);
+    writer.write(image ? hasImage : 0U);
+    writer.write(atlas.width);
+    writer.write(atlas.height);
+    writer.write(atlas.atlasCount);
+    writer.write(atlas.chartCount);
+    writer.write(atlas.meshCount);
+    writer.write(&atlas.texelsPerUnit, 1);
+    writer.write(atlas.utilization, atlas.atlasCount);
+
+    for (std::uint32_t m = 0; m < atlas.meshCount; ++m)
+    {
+        auto const& mesh = atlas.meshes[m];
+        writer.write(mesh.vertexCount);
+        writer.write(mesh.indexCount);
+        writer.write(mesh.chartCount);
+        if (remaps && m < remaps->size() && !(*remaps)[m].empty())
+        {
+            auto const& remap = (*remaps)[m];
+            for (std::uint32_t v = 0; v < mesh.vertexCount; ++v)
+            {
+                xatlas::Vertex vertex = mesh.vertexArray[v];
+                vertex.xref           = remap[vertex.xref];
+                writer.write(&vertex, 1);
+            }
+        }
+        else
+        {
+            writer.write(mesh.vertexArray, mesh.vertexCount);
+        }
+        writer.write(mesh.indexArray, mesh.indexCount);
+
+        for (std::uint32_t c = 0; c < mesh.chartCount; ++c)
+        {
+            auto const& chart = mesh.chartArray[c];
+            writer.write(chart.atlasIndex);
+            writer.write(static_cast<std::uint32_t>(chart.type));
+            writer.write(chart.material);
+            writer.write(chart.faceCount);
+            writer.write(chart.faceArray, chart.faceCount);
+        }
+    }
+
+    if (image)
+    {
+        writer.write(atlas.image, imageSize(atlas));
+    }
+}
+
+void saveAtlas(xatlas::Atlas const& atlas, bool includeImage, std::string const& path, VertexRemaps const* remaps)
+{
+    std::vector<char> buffer(serializedSize(atlas, includeImage));
+    serializeAtlas(atlas, includeImage, buffer.data(), remaps);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::invalid_argument("Cannot open path " + path);
+    }
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    if (!file)
+    {
+        throw std::runtime_error("Writing to path " + path + " failed");
+    }
+}
+
+std::unique_ptr<RestoredAtlas> RestoredAtlas::fromBuffer(std::vector<char> buffer)
+{
+    std::unique_ptr<RestoredAtlas> restored(new RestoredAtlas());
+    restored->m_buffer = std::move(buffer);
+    restored->parse(restored->m_buffer.data(), restored->m_buffer.size());
+    return restored;
+}
+
+std::unique_ptr<RestoredAtlas> RestoredAtlas::fromFile(std::string const& path, bool map)
+{
+    auto file = std::make_unique<MappedFile>(path);
+    if (!map)
+    {
+        // Copy the file once instead of keeping it open
+        return fromBuffer(std::vector<char>(file->data(), file->data() + file->size()));
+    }
+
+    std::unique_ptr<RestoredAtlas> restored(new RestoredAtlas());
+    restored->m_file = std::move(file);
+    restored->parse(restored->m_file->data(), restored->m_file->size());
+    return restored;
+}
+
+void RestoredAtlas::parse(char const* data, std::size_t size)
+{
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint32_t) != 0)
+    {
+        throw std::runtime_error("Atlas data is not aligned.");
+    }
+
+    Reader reader(data, size);
+    if (size < sizeof(magic) || std::memcmp(reader.read<char>(sizeof(magic)), magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("The data is not a serialized atlas.");
+    }
+    if (reader.readUInt() != version)
+    {
+        throw std::runtime_error("Unsupported version of serialized atlas.");
+    }
+    if (reader.readUInt() != byteOrder)
+    {
+        throw std::runtime_error("The atlas was serialized on a platform with different byte order.");
+    }
+
+    std::uint32_t const flags = reader.readUInt();
+
+    // The arrays are never written, xatlas just does not declare them const
+    m_atlas               = xatlas::Atlas();
+    m_atlas.width         = reader.readUInt();
+    m_atlas.height        = reader.readUInt();
+    m_atlas.atlasCount    = reader.readUInt();
+    m_atlas.chartCount    = reader.readUInt();
+    m_atlas.meshCount     = reader.readUInt();
+    m_atlas.texelsPerUnit = *reader.read<float>(1);
+    m_atlas.utilization   = const_cast<float*>(reader.read<float>(m_atlas.atlasCount));
+
+    if (m_atlas.meshCount > size / (3 * sizeof(std::uint32_t)))
+    {
+        throw std::runtime_error("Invalid or truncated atlas data.");
+    }
+
+    m_meshes.resize(m_atlas.meshCount);
+    m_charts.clear();
+    std::vector<std::size_t> firstCharts(m_atlas.meshCount);
+    for (auto& mesh : m_meshes)
+    {
+        mesh             = xatlas::Mesh();
+        mesh.vertexCount = reader.readUInt();
+        mesh.indexCount  = reader.readUInt();
+        mesh.chartCount  = reader.readUInt();
+        mesh.vertexArray = const_cast<xatlas::Vertex*>(reader.read<xatlas::Vertex>(mesh.vertexCount));
+        mesh.indexArray  = const_cast<std::uint32_t*>(reader.read<std::uint32_t>(mesh.indexCount));
+
+        firstCharts[static_cast<std::size_t>(&mesh - m_meshes.data())] = m_charts.size();
+        for (std::uint32_t c = 0; c < mesh.chartCount; ++c)
+        {
+            xatlas::Chart chart = xatlas::Chart();
+            chart.atlasIndex    = reader.readUInt();
+            chart.type          = static_cast<xatlas::ChartType>(reader.readUInt());
+            chart.material      = reader.readUInt();
+            chart.faceCount     = reader.readUInt();
+            chart.faceArray     = const_cast<std::uint32_t*>(reader.read<std::uint32_t>(chart.faceCount));
+            if (chart.atlasIndex >= m_atlas.atlasCount)
+            {
+                throw std::runtime_error("Invalid or truncated atlas data.");
+            }
+            for (std::uint32_t f = 0; f < chart.faceCount; ++f)
+            {
+                if (chart.faceArray[f] >= mesh.indexCount / 3)
+                {
+                    throw std::runtime_error("Invalid or truncated atlas data.");
+                }
+            }
+            m_charts.push_back(chart);
+        }
+
+        // Reject indices that would let the getters read out of bounds
+        for (std::uint32_t i = 0; i < mesh.indexCount; ++i)
+        {
+            if (mesh.indexArray[i] >= mesh.vertexCount)
+            {
+                throw std::runtime_error("Invalid or truncated atlas data.");
+            }
+        }
+
+        // Vertices without a chart have the indices -1
+        for (std::uint32_t v = 0; v < mesh.vertexCount; ++v)
+        {
+            xatlas::Vertex const& vertex = mesh.vertexArray[v];
+            if (vertex.atlasIndex < -1 || vertex.atlasIndex >= std::int64_t(m_atlas.atlasCount) || vertex.chartIndex < -1 || vertex.chartIndex >= std::int64_t(m_atlas.chartCount))
+            {
+                throw std::runtime_error("Invalid or truncated atlas data.");
+            }
+        }
+    }
+
+    // Charts are only referenced after all of them have been read, because the vector may grow
+    for (std::size_t m = 0; m < m_meshes.size(); ++m)
+    {
+        m_meshes[m].chartArray = m_meshes[m].chartCount > 0 ? m_charts.data() + firstCharts[m] : nullptr;
+    }
+    m_atlas.meshes = m_meshes.empty() ? nullptr : m_meshes.data();
+
+    m_atlas.image = nullptr;
+    if (flags & hasImage)
+    {
+        m_atlas.image = const_cast<std::uint32_t*>(reader.read<std::uint32_t>(imageSize(m_atlas)));
+        for (std::size_t i = 0; i < imageSize(m_atlas); ++i)
+        {
+            std::uint32_t const data = m_atlas.image[i];
+            if (data != 0 && !(data & (xatlas::kImageIsPaddingBit | xatlas::kImageIsBilinearBit)) && (data & xatlas::kImageChartIndexMask) >= m_atlas.chartCount)
+            {
+                throw std::runtime_error("Invalid or truncated atlas data.");
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "mappedfile.hpp"
+
+#include <xatlas.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary format of the output of an atlas. All values are 32-bit and stored in native (little endian) byte order:
+//
+//   char[8]  magic "XATLASPY"
+//   uint32   version, byte order mark (0x01020304), flags (bit 0: image)
+//   uint32   width, height, atlas count, chart count, mesh count
+//   float    texels per unit
+//   float    utilization[atlas count]
+//   per mesh:
+//     uint32         vertex count, index count, chart count
+//     xatlas::Vertex vertices[vertex count] (atlasIndex, chartIndex, uv[2], xref)
+//     uint32         indices[index count]
+//     per chart:
+//       uint32 atlas index, type, material, face count
+//       uint32 faces[face count]
+//   uint32   image[atlas count * height * width] (if flag set)
+//
+// Every array is 4-byte aligned, so a restored atlas references a buffer or memory mapping without copying.
+
+// Original vertex index of each vertex that was added to xatlas, per mesh (empty if the vertices were not remapped, e.g. by welding)
+using VertexRemaps = std::vector<std::vector<std::uint32_t>>;
+
+// Number of bytes needed to serialize the output of `atlas`
+std::size_t serializedSize(xatlas::Atlas const& atlas, bool includeImage);
+
+// Writes the output of `atlas` to `out`, which has space for `serializedSize(atlas, includeImage)` bytes.
+// With `remaps`, the vertex references (`xref`) are stored as original vertex indices.
+void serializeAtlas(xatlas::Atlas const& atlas, bool includeImage, char* out, VertexRemaps const* remaps = nullptr);
+
+void saveAtlas(xatlas::Atlas const& atlas, bool includeImage, std::string const& path, VertexRemaps const* remaps = nullptr);
+
+// Output of an atlas restored from its serialized form. The vertex, index, face and image arrays
+// reference the serialized data, only the mesh and chart descriptions are rebuilt.
+class RestoredAtlas
+{
+public:
+    static std::unique_ptr<RestoredAtlas> fromBuffer(std::vector<char> buffer);
+
+    // Reads the file into memory or (with `map`) maps it, in which case its pages are only read when accessed
+    static std::unique_ptr<RestoredAtlas> fromFile(std::string const& path, bool map);
+
+    xatlas::Atlas const& atlas() const { return m_atlas; }
+
+private:
+    RestoredAtlas() = default;
+
+    void parse(char const* data, std::size_t size);
+
+    std::vector<char>           m_buffer;
+    std::unique_ptr<MappedFile> m_file;
+    std::vector<xatlas::Mesh>   m_meshes;
+    std::vector<xatlas::Chart>  m_charts;
+    xatlas::Atlas               m_atlas;
+};
@@ -0,0 +1,274 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "threading.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+std::atomic<unsigned int> g_threadCount(0); // 0 uses the hardware concurrency
+
+// Threads that run the helper tasks of `parallelFor` and the asynchronous jobs. They are started on demand and kept until the
+// pool is resized, so short parallel loops do not pay for creating threads.
+class ThreadPool
+{
+public:
+    // Makes sure that at least `size` threads exist
+    void reserve(std::size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (m_threads.size() < size)
+        {
+            m_threads.emplace_back(&ThreadPool::run, this);
+        }
+    }
+
+    // Stops all threads and starts `size` new ones. Queued tasks are kept.
+    void resize(std::size_t size)
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(threads, m_threads);
+            m_generation++;
+        }
+        m_wakeup.notify_all();
+
+        for (auto& thread : threads)
+        {
+            // A task that resizes the pool (e.g. a callback of a job) cannot join its own thread,
+            // which returns after the task
+            if (thread.get_id() == std::this_thread::get_id())
+            {
+                thread.detach();
+            }
+            else
+            {
+                thread.join();
+            }
+        }
+
+        reserve(size);
+    }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_wakeup.notify_one();
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_threads.size();
+    }
+
+    static bool isWorker() { return t_worker; }
+
+private:
+    void run()
+    {
+        t_worker = true;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::size_t const            generation = m_generation;
+        while (true)
+        {
+            m_wakeup.wait(lock, [&]() { return !m_tasks.empty() || m_generation != generation; });
+            if (m_generation != generation)
+            {
+                return;
+            }
+
+            std::function<void()> task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex                        m_mutex;
+    std::condition_variable           m_wakeup;
+    std::vector<std::thread>          m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::size_t                       m_generation = 0;
+
+    static thread_local bool t_worker;
+};
+
+thread_local bool ThreadPool::t_worker = false;
+
+// Never destroyed: joining threads while the module is unloaded can deadlock (e.g. under the Windows loader lock)
+ThreadPool& sharedPool()
+{
+    static ThreadPool* pool = new ThreadPool();
+    return *pool;
+}
+
+// State of one `parallelFor` call, shared with its helper tasks. Helpers that start after the
+// calling thread finished (because the pool was busy) find it closed and return immediately.
+struct Loop
+{
+    std::function<void(std::size_t, std::size_t)> const* function;
+    std::size_t                                          count;
+    std::size_t                                          grainSize;
+    std::size_t                                          chunkCount;
+
+    std::atomic<std::size_t> nextChunk{0};
+    std::atomic<bool>        failed{false};
+
+    std::mutex              mutex; // Guards the following members
+    std::condition_variable finished;
+    std::exception_ptr      exception;
+    std::size_t             active = 0;
+    bool                    closed = false;
+
+    void work()
+    {
+        while (!failed)
+        {
+            std::size_t const chunk = nextChunk++;
+            if (chunk >= chunkCount)
+            {
+                break;
+            }
+
+            std::size_t const begin = chunk * grainSize;
+            try
+            {
+                (*function)(begin, std::min(begin + grainSize, count));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    }
+
+    void help()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed)
+            {
+                return;
+            }
+            active++;
+        }
+
+        work();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        active--;
+        finished.notify_all();
+    }
+};
+
+} // namespace
+
+unsigned int defaultThreadCount()
+{
+    unsigned int const threadCount = g_threadCount;
+    return threadCount > 0 ? threadCount : std::max(1U, std::thread::hardware_concurrency());
+}
+
+void setThreadCount(unsigned int threadCount)
+{
+    g_threadCount = threadCount;
+    // Keeps a thread for the queued jobs of `submitTask`
+    sharedPool().resize(std::max(1U, defaultThreadCount() - 1));
+}
+
+void submitTask(std::function<void()> task)
+{
+    ThreadPool& pool = sharedPool();
+    pool.reserve(std::max(1U, defaultThreadCount() - 1));
+    pool.submit(std::move(task));
+}
+
+void parallelFor(std::size_t count, std::size_t grainSize, std::function<void(std::size_t, std::size_t)> const& function, unsigned int threadCount)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grainSize = std::max<std::size_t>(grainSize, 1);
+
+    std::size_t const chunkCount  = (count + grainSize - 1) / grainSize;
+    std::size_t const workerCount = std::min<std::size_t>(threadCount == 0 ? defaultThreadCount() : threadCount, chunkCount);
+
+    // Avoid the overhead for small workloads. Nested loops run serially, they would only compete for the same threads.
+    if (workerCount <= 1 || ThreadPool::isWorker())
+    {
+        function(0, count);
+        return;
+    }
+
+    auto loop        = std::make_shared<Loop>();
+    loop->function   = &function;
+    loop->count      = count;
+    loop->grainSize  = grainSize;
+    loop->chunkCount = chunkCount;
+
+    ThreadPool& pool = sharedPool();
+    pool.reserve(workerCount - 1);
+    for (std::size_t i = 0; i + 1 < workerCount; ++i)
+    {
+        pool.submit([loop]() { loop->help(); });
+    }
+
+    // The calling thread participates in the work, so the loop finishes even if the pool is busy
+    loop->work();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->closed = true;
+    loop->finished.wait(lock, [&]() { return loop->active == 0; });
+
+    if (loop->exception)
+    {
+        std::rethrow_exception(loop->exception);
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Number of threads used for parallel work if no explicit count is given.
+// Defaults to the hardware concurrency and can be changed with `setThreadCount`.
+unsigned int defaultThreadCount();
+
+// Sets the default number of threads (0 restores the hardware concurrency).
+// The shared pool is resized accordingly, 1 runs all parallel work on the calling thread.
+// The task schedulers of xatlas are sized by the default at the creation of an atlas and limited to it per operation.
+// They are not shared: every atlas starts and stops its own worker threads.
+void setThreadCount(unsigned int threadCount);
+
+// Runs `task` on a thread of the shared pool, which has at least one thread for this. Tasks wait while all threads are busy.
+// Loops of `parallelFor` in the task run on its thread only.
+void submitTask(std::function<void()> task);
+
+// Calls `function(begin, end)` for consecutive ranges of at most `grainSize` elements that cover [0, count).
+// The ranges are distributed over `threadCount` threads (0 uses `defaultThreadCount()`), including the calling thread.
+// The other threads are taken from a pool that is shared by all calls and persists between them.
+// If the function throws, no further ranges are started and the first exception is rethrown after all threads finished.
+void parallelFor(std::size_t count, std::size_t grainSize, std::function<void(std::size_t, std::size_t)> const& function, unsigned int threadCount = 0);
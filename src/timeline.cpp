@@ -0,0 +1,189 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "timeline.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+
+// Spans kept for traces. Long-lived atlases keep their totals, but not every `get_mesh` call.
+constexpr std::size_t const maxSpans = 1 << 16;
+
+// Stage names match the members of `xatlas.ProgressCategory`
+char const* stageName(xatlas::ProgressCategory category)
+{
+    switch (category)
+    {
+    case xatlas::ProgressCategory::AddMesh: return "AddMesh";
+    case xatlas::ProgressCategory::ComputeCharts: return "ComputeCharts";
+    case xatlas::ProgressCategory::PackCharts: return "PackCharts";
+    case xatlas::ProgressCategory::BuildOutputMeshes: return "BuildOutputMeshes";
+    }
+
+    return "Unknown";
+}
+
+double toMicroseconds(Timeline::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+} // namespace
+
+Timeline::Scope::Scope(Timeline& timeline, char const* name)
+    : m_timeline(timeline)
+    , m_name(name)
+    , m_start(Clock::now())
+{
+}
+
+Timeline::Scope::~Scope()
+{
+    auto const end = Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_timeline.m_mutex);
+
+    // A cancelled stage never reports completion. Meshes are processed asynchronously,
+    // so the AddMesh stage lasts until the meshes are joined by the next operation.
+    if (m_timeline.m_stage != xatlas::ProgressCategory::AddMesh)
+    {
+        m_timeline.closeStage(end);
+    }
+    m_timeline.add(m_name, "operation", m_start, end, std::this_thread::get_id());
+}
+
+Timeline::Timeline()
+    : m_origin(Clock::now())
+    , m_droppedSpans(0)
+{
+}
+
+void Timeline::stage(xatlas::ProgressCategory category, int progress)
+{
+    auto const now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_stage != category)
+    {
+        closeStage(now);
+        m_stage      = category;
+        m_stageStart = now;
+    }
+
+    if (progress >= 100)
+    {
+        closeStage(now);
+    }
+}
+
+std::map<std::string, Timeline::Total> Timeline::operations() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_operations;
+}
+
+std::map<std::string, Timeline::Total> Timeline::stages() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stages;
+}
+
+void Timeline::writeTrace(std::string const& path) const
+{
+    std::ofstream file(path);
+
+    if (!file.is_open())
+    {
+        throw std::invalid_argument("Cannot open path " + path);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"xatlas\"}}";
+    for (size_t i = 0; i < m_threads.size(); ++i)
+    {
+        file << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i + 1 << ", \"args\": {\"name\": \"thread " << i + 1 << "\"}}";
+    }
+
+    file.precision(3);
+    file << std::fixed;
+    for (auto const& span : m_spans)
+    {
+        file << ",\n{\"name\": \"" << span.name << "\", \"cat\": \"" << span.category << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << span.thread
+             << ", \"ts\": " << toMicroseconds(span.start - m_origin) << ", \"dur\": " << toMicroseconds(span.end - span.start) << "}";
+    }
+
+    file << "\n], \"otherData\": {\"droppedSpans\": " << m_droppedSpans << "}}\n";
+
+    file.flush();
+    if (!file)
+    {
+        throw std::runtime_error("Writing to path " + path + " failed");
+    }
+}
+
+void Timeline::add(std::string name, char const* category, Clock::time_point start, Clock::time_point end, std::thread::id thread)
+{
+    auto& totals = std::strcmp(category, "stage") == 0 ? m_stages : m_operations;
+    auto& total  = totals[name];
+    total.count += 1;
+    total.seconds += std::chrono::duration<double>(end - start).count();
+
+    if (m_spans.size() >= maxSpans)
+    {
+        ++m_droppedSpans;
+        return;
+    }
+
+    std::uint32_t threadIndex = 0;
+    if (thread != std::thread::id())
+    {
+        auto it = std::find(m_threads.begin(), m_threads.end(), thread);
+        if (it == m_threads.end())
+        {
+            it = m_threads.insert(m_threads.end(), thread);
+        }
+        threadIndex = static_cast<std::uint32_t>(it - m_threads.begin()) + 1;
+    }
+
+    m_spans.push_back({std::move(name), category, start, end, threadIndex});
+}
+
+void Timeline::closeStage(Clock::time_point end)
+{
+    if (!m_stage)
+    {
+        return;
+    }
+
+    add(stageName(*m_stage), "stage", m_stageStart, end, std::thread::id());
+    m_stage.reset();
+}
@@ -0,0 +1,103 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <xatlas.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the wall-clock time of the operations of an atlas and of the xatlas stages they run.
+// Totals are kept for the lifetime of the atlas, individual spans (for traces) up to a limit.
+class Timeline
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Span
+    {
+        std::string       name;
+        char const*       category; // "operation" or "stage"
+        Clock::time_point start;
+        Clock::time_point end;
+        std::uint32_t     thread; // 0 for xatlas stages (which run on several threads), otherwise 1 + index of the calling thread
+    };
+
+    struct Total
+    {
+        std::size_t count   = 0;
+        double      seconds = 0.0;
+    };
+
+    // Records an operation for the lifetime of the scope
+    class Scope
+    {
+    public:
+        Scope(Timeline& timeline, char const* name);
+        ~Scope();
+
+        Scope(Scope const&)            = delete;
+        Scope& operator=(Scope const&) = delete;
+
+    private:
+        Timeline&         m_timeline;
+        char const*       m_name;
+        Clock::time_point m_start;
+    };
+
+    Timeline();
+
+    // Tracks the stage of xatlas from its progress updates (thread-safe)
+    void stage(xatlas::ProgressCategory category, int progress);
+
+    std::map<std::string, Total> operations() const;
+    std::map<std::string, Total> stages() const;
+
+    // Writes the recorded spans in the Chrome trace event format (chrome://tracing, Perfetto)
+    void writeTrace(std::string const& path) const;
+
+private:
+    void add(std::string name, char const* category, Clock::time_point start, Clock::time_point end, std::thread::id thread);
+
+    // Closes the open stage (requires the mutex)
+    void closeStage(Clock::time_point end);
+
+    mutable std::mutex                      m_mutex;
+    Clock::time_point                       m_origin;
+    std::vector<Span>                       m_spans;
+    std::size_t                             m_droppedSpans;
+    std::map<std::string, Total>            m_operations;
+    std::map<std::string, Total>            m_stages;
+    std::vector<std::thread::id>            m_threads;
+    std::optional<xatlas::ProgressCategory> m_stage;
+    Clock::time_point                       m_stageStart;
+};
@@ -0,0 +1,467 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "weld.hpp"
+#include "threading.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace py = pybind11;
+
+namespace
+{
+
+// Positions are sorted into a grid with cells of `cellScale` times the tolerance, so most
+// vertices are far enough from the cell boundaries to only look up their own cell
+constexpr float const cellScale = 4.0f;
+
+constexpr std::size_t const bucketBits  = 8;
+constexpr std::size_t const bucketCount = std::size_t(1) << bucketBits;
+
+struct Entry
+{
+    std::uint64_t key;
+    std::uint32_t index;
+
+    bool operator<(Entry const& other) const { return key < other.key || (key == other.key && index < other.index); }
+};
+
+inline std::uint64_t mix(std::uint64_t x)
+{
+    // SplitMix64 finalizer, spreads the keys over the buckets
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline std::uint64_t cellKey(std::int64_t x, std::int64_t y, std::int64_t z)
+{
+    return mix(static_cast<std::uint64_t>(x) * 0x9E3779B97F4A7C15ULL ^ mix(static_cast<std::uint64_t>(y) + 0x632BE59BD9B4E019ULL) ^ mix(static_cast<std::uint64_t>(z) * 0x85EBCA77C2B2AE63ULL));
+}
+
+class Welder
+{
+public:
+    Welder(xatlas::MeshDecl const& mesh, WeldOptions const& options)
+        : m_mesh(mesh)
+        , m_options(options)
+        , m_cellSize(options.epsilon * cellScale)
+    {
+    }
+
+    float const* position(std::uint32_t i) const { return attribute(m_mesh.vertexPositionData, m_mesh.vertexPositionStride, i); }
+    float const* normal(std::uint32_t i) const { return attribute(m_mesh.vertexNormalData, m_mesh.vertexNormalStride, i); }
+    float const* uv(std::uint32_t i) const { return attribute(m_mesh.vertexUvData, m_mesh.vertexUvStride, i); }
+
+    // Grid cell (or exact position) of a vertex, and the neighboring cells that may contain vertices within the tolerance
+    std::size_t keys(std::uint32_t i, std::array<std::uint64_t, 8>& keys) const
+    {
+        float const* p = position(i);
+
+        bool finite = m_cellSize > 0.0f;
+        std::array<std::int64_t, 3> cell{};
+        std::array<std::int64_t, 3> neighbor{};
+        for (int axis = 0; axis < 3 && finite; ++axis)
+        {
+            float const scaled = p[axis] / m_cellSize;
+            finite             = std::isfinite(scaled) && std::fabs(scaled) < 1e18f;
+            if (finite)
+            {
+                float const cellStart = std::floor(scaled);
+                cell[axis]            = static_cast<std::int64_t>(cellStart);
+
+                // Only cells within the tolerance of the position need to be searched
+                float const fraction = (scaled - cellStart) * cellScale;
+                neighbor[axis]       = fraction <= 1.0f ? -1 : (fraction >= cellScale - 1.0f ? 1 : 0);
+            }
+        }
+
+        if (!finite)
+        {
+            // Identical positions (with -0 == 0) in the same "cell"
+            std::array<float, 3> normalized{p[0] + 0.0f, p[1] + 0.0f, p[2] + 0.0f};
+            std::uint64_t        key = 0;
+            for (float value : normalized)
+            {
+                std::uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                key = mix(key ^ bits);
+            }
+            keys[0] = key;
+            return 1;
+        }
+
+        std::size_t count = 0;
+        for (int dx = 0; dx < (neighbor[0] != 0 ? 2 : 1); ++dx)
+        {
+            for (int dy = 0; dy < (neighbor[1] != 0 ? 2 : 1); ++dy)
+            {
+                for (int dz = 0; dz < (neighbor[2] != 0 ? 2 : 1); ++dz)
+                {
+                    keys[count++] = cellKey(cell[0] + dx * neighbor[0], cell[1] + dy * neighbor[1], cell[2] + dz * neighbor[2]);
+                }
+            }
+        }
+
+        return count;
+    }
+
+    // Whether two vertices have the same values in all compared attributes, so they match the same vertices
+    bool identical(std::uint32_t a, std::uint32_t b) const
+    {
+        if (!std::equal(position(a), position(a) + 3, position(b)))
+        {
+            return false;
+        }
+
+        if (m_options.matchNormals && m_mesh.vertexNormalData && !std::equal(normal(a), normal(a) + 3, normal(b)))
+        {
+            return false;
+        }
+
+        return !(m_options.matchUvs && m_mesh.vertexUvData && !std::equal(uv(a), uv(a) + 2, uv(b)));
+    }
+
+    bool matches(std::uint32_t a, std::uint32_t b) const
+    {
+        float const* pa = position(a);
+        float const* pb = position(b);
+        if (m_cellSize > 0.0f)
+        {
+            float const dx = pa[0] - pb[0];
+            float const dy = pa[1] - pb[1];
+            float const dz = pa[2] - pb[2];
+            if (!(dx * dx + dy * dy + dz * dz <= m_options.epsilon * m_options.epsilon))
+            {
+                return false;
+            }
+        }
+        else if (!(pa[0] == pb[0] && pa[1] == pb[1] && pa[2] == pb[2]))
+        {
+            return false;
+        }
+
+        if (m_options.matchNormals && m_mesh.vertexNormalData && !close(normal(a), normal(b), 3, m_options.normalEpsilon))
+        {
+            return false;
+        }
+
+        if (m_options.matchUvs && m_mesh.vertexUvData && !close(uv(a), uv(b), 2, m_options.uvEpsilon))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    static float const* attribute(void const* data, std::uint32_t stride, std::uint32_t i)
+    {
+        return reinterpret_cast<float const*>(static_cast<char const*>(data) + static_cast<std::size_t>(stride) * i);
+    }
+
+    static bool close(float const* a, float const* b, int components, float epsilon)
+    {
+        for (int c = 0; c < components; ++c)
+        {
+            if (!(std::fabs(a[c] - b[c]) <= epsilon))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    xatlas::MeshDecl const& m_mesh;
+    WeldOptions const&      m_options;
+    float const             m_cellSize;
+};
+
+} // namespace
+
+void WeldOptions::hash(Hasher& hasher) const
+{
+    hasher.update(epsilon);
+    hasher.update(matchNormals);
+    hasher.update(normalEpsilon);
+    hasher.update(matchUvs);
+    hasher.update(uvEpsilon);
+}
+
+void WeldOptions::bind(pybind11::module& m)
+{
+    py::class_<WeldOptions>(m, "WeldOptions")
+        .def(py::init<>())
+        .def_readwrite("epsilon", &WeldOptions::epsilon, "Maximum distance of welded positions. 0 only welds identical positions.")
+        .def_readwrite("match_normals", &WeldOptions::matchNormals, "Only weld vertices whose normals differ by at most normal_epsilon (per component).")
+        .def_readwrite("normal_epsilon", &WeldOptions::normalEpsilon)
+        .def_readwrite("match_uvs", &WeldOptions::matchUvs, "Only weld vertices whose texture coordinates differ by at most uv_epsilon (per component).")
+        .def_readwrite("uv_epsilon", &WeldOptions::uvEpsilon);
+}
+
+xatlas::MeshDecl WeldedMesh::meshDecl() const
+{
+    xatlas::MeshDecl meshDecl = original;
+
+    meshDecl.vertexCount          = static_cast<std::uint32_t>(remap.size());
+    meshDecl.vertexPositionData   = positions.data();
+    meshDecl.vertexPositionStride = sizeof(float) * 3;
+    meshDecl.vertexNormalData     = normals.empty() ? nullptr : normals.data();
+    meshDecl.vertexNormalStride   = normals.empty() ? 0 : sizeof(float) * 3;
+    meshDecl.vertexUvData         = uvs.empty() ? nullptr : uvs.data();
+    meshDecl.vertexUvStride       = uvs.empty() ? 0 : sizeof(float) * 2;
+
+    meshDecl.indexCount  = static_cast<std::uint32_t>(indices.size());
+    meshDecl.indexData   = indices.data();
+    meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
+    meshDecl.indexOffset = 0;
+
+    return meshDecl;
+}
+
+WeldedMesh weldMesh(xatlas::MeshDecl const& mesh, WeldOptions const& options, unsigned int threadCount)
+{
+    std::uint32_t const vertexCount = mesh.vertexCount;
+    std::size_t const   grainSize   = 4096;
+
+    Welder const welder(mesh, options);
+
+    // Sort the vertices by their cell. The keys are partitioned by their top bits first,
+    // so the buckets can be filled and sorted in parallel.
+    std::vector<Entry> unsorted(vertexCount);
+    parallelFor(vertexCount, grainSize, [&](std::size_t begin, std::size_t end) {
+        std::array<std::uint64_t, 8> keys;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            welder.keys(static_cast<std::uint32_t>(i), keys);
+            unsorted[i] = {keys[0], static_cast<std::uint32_t>(i)};
+        }
+    }, threadCount);
+
+    std::size_t const        chunkCount = (vertexCount + grainSize - 1) / grainSize;
+    std::vector<std::size_t> offsets(chunkCount * bucketCount, 0);
+    parallelFor(chunkCount, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk < end; ++chunk)
+        {
+            for (std::size_t i = chunk * grainSize; i < std::min<std::size_t>((chunk + 1) * grainSize, vertexCount); ++i)
+            {
+                offsets[chunk * bucketCount + (unsorted[i].key >> (64 - bucketBits))]++;
+            }
+        }
+    }, threadCount);
+
+    std::vector<std::size_t> bucketStart(bucketCount + 1, 0);
+    std::size_t              offset = 0;
+    for (std::size_t bucket = 0; bucket < bucketCount; ++bucket)
+    {
+        bucketStart[bucket] = offset;
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            std::size_t const count                 = offsets[chunk * bucketCount + bucket];
+            offsets[chunk * bucketCount + bucket] = offset;
+            offset += count;
+        }
+    }
+    bucketStart[bucketCount] = offset;
+
+    std::vector<Entry> entries(vertexCount);
+    parallelFor(chunkCount, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk < end; ++chunk)
+        {
+            for (std::size_t i = chunk * grainSize; i < std::min<std::size_t>((chunk + 1) * grainSize, vertexCount); ++i)
+            {
+                entries[offsets[chunk * bucketCount + (unsorted[i].key >> (64 - bucketBits))]++] = unsorted[i];
+            }
+        }
+    }, threadCount);
+
+    parallelFor(bucketCount, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t bucket = begin; bucket < end; ++bucket)
+        {
+            std::sort(entries.begin() + bucketStart[bucket], entries.begin() + bucketStart[bucket + 1]);
+        }
+    }, threadCount);
+
+    unsorted = std::vector<Entry>();
+
+    // Join each vertex with all lower matching vertices in its own and the neighboring cells. The sets are
+    // linked to their lowest vertex, so the result does not depend on the order in which the threads join them.
+    std::vector<std::atomic<std::uint32_t>> parents(vertexCount);
+    for (std::uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        parents[vertex].store(vertex, std::memory_order_relaxed);
+    }
+
+    auto const find = [&](std::uint32_t vertex) {
+        while (true)
+        {
+            std::uint32_t parent = parents[vertex].load(std::memory_order_relaxed);
+            if (parent == vertex)
+            {
+                return vertex;
+            }
+
+            // Path halving, the grandparent is in the same set and lower
+            std::uint32_t const grandparent = parents[parent].load(std::memory_order_relaxed);
+            if (grandparent != parent)
+            {
+                parents[vertex].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            }
+            vertex = grandparent;
+        }
+    };
+
+    auto const unite = [&](std::uint32_t a, std::uint32_t b) {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+            {
+                return;
+            }
+            if (a < b)
+            {
+                std::swap(a, b);
+            }
+
+            // Link the higher root to the lower one, unless another thread linked it meanwhile
+            std::uint32_t expected = a;
+            if (parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+    };
+
+    parallelFor(vertexCount, grainSize, [&](std::size_t begin, std::size_t end) {
+        std::array<std::uint64_t, 8> keys;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            std::uint32_t const vertex = static_cast<std::uint32_t>(i);
+
+            std::size_t const keyCount = welder.keys(vertex, keys);
+            for (std::size_t k = 0; k < keyCount; ++k)
+            {
+                std::size_t const bucket = keys[k] >> (64 - bucketBits);
+                auto              it     = std::lower_bound(entries.begin() + bucketStart[bucket], entries.begin() + bucketStart[bucket + 1], Entry{keys[k], 0});
+                bool              copy   = false;
+                for (; it != entries.end() && it->key == keys[k] && it->index < vertex; ++it)
+                {
+                    if (find(it->index) != find(vertex) && welder.matches(it->index, vertex))
+                    {
+                        unite(it->index, vertex);
+                    }
+
+                    // A lower identical vertex already joined all lower vertices that match this one
+                    if (welder.identical(it->index, vertex))
+                    {
+                        copy = true;
+                        break;
+                    }
+                }
+                if (copy)
+                {
+                    break;
+                }
+            }
+        }
+    }, threadCount);
+
+    entries = std::vector<Entry>();
+
+    // Number the welded vertices by their lowest vertex
+    WeldedMesh result;
+    result.original = mesh;
+
+    std::vector<std::uint32_t> welded(vertexCount);
+    for (std::uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        std::uint32_t const lowest = find(vertex);
+        if (lowest == vertex)
+        {
+            welded[vertex] = static_cast<std::uint32_t>(result.remap.size());
+            result.remap.push_back(vertex);
+        }
+        else
+        {
+            welded[vertex] = welded[lowest];
+        }
+    }
+
+    // Gather the attributes of the welded vertices
+    std::size_t const weldedCount = result.remap.size();
+    result.positions.resize(weldedCount * 3);
+    if (mesh.vertexNormalData)
+    {
+        result.normals.resize(weldedCount * 3);
+    }
+    if (mesh.vertexUvData)
+    {
+        result.uvs.resize(weldedCount * 2);
+    }
+
+    parallelFor(weldedCount, grainSize, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            std::uint32_t const vertex = result.remap[i];
+            std::copy_n(welder.position(vertex), 3, &result.positions[i * 3]);
+            if (!result.normals.empty())
+            {
+                std::copy_n(welder.normal(vertex), 3, &result.normals[i * 3]);
+            }
+            if (!result.uvs.empty())
+            {
+                std::copy_n(welder.uv(vertex), 2, &result.uvs[i * 2]);
+            }
+        }
+    }, threadCount);
+
+    // Redirect the indices, meshes without indices are implicitly indexed
+    std::size_t const indexCount = mesh.indexData ? mesh.indexCount : vertexCount;
+    result.indices.resize(indexCount);
+    parallelFor(indexCount, grainSize * 4, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            std::int64_t index = static_cast<std::int64_t>(i);
+            if (mesh.indexData)
+            {
+                index = mesh.indexFormat == xatlas::IndexFormat::UInt16 ? static_cast<std::uint16_t const*>(mesh.indexData)[i] : static_cast<std::uint32_t const*>(mesh.indexData)[i];
+                index += mesh.indexOffset;
+            }
+
+            result.indices[i] = index >= 0 && index < vertexCount ? welded[static_cast<std::size_t>(index)] : std::numeric_limits<std::uint32_t>::max();
+        }
+    }, threadCount);
+
+    return result;
+}
@@ -0,0 +1,67 @@
+/**
+ * MIT License
+ * 
+ * Copyright (c) 2021 Markus Worchel
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "hash.hpp"
+
+#include <pybind11/pybind11.h>
+
+#include <xatlas.h>
+
+#include <cstdint>
+#include <vector>
+
+// Options of the welding pre-pass, which merges vertices of triangle soups before they are added to an atlas
+struct WeldOptions
+{
+    float epsilon       = 0.0f;   // Maximum distance of welded positions (0 only welds identical positions)
+    bool  matchNormals  = false;  // Only weld vertices with similar normals
+    float normalEpsilon = 1e-3f;  // Maximum difference of each normal component
+    bool  matchUvs      = false;  // Only weld vertices with similar texture coordinates
+    float uvEpsilon     = 1e-6f;  // Maximum difference of each texture coordinate
+
+    void hash(Hasher& hasher) const;
+
+    static void bind(pybind11::module& m);
+};
+
+// Mesh with welded vertices. Each welded vertex is represented by the first (lowest index) vertex
+// of its group, `remap` holds the original index of every welded vertex.
+struct WeldedMesh
+{
+    // Declaration of the welded mesh, other fields (e.g. face materials) are taken from the original declaration
+    xatlas::MeshDecl meshDecl() const;
+
+    xatlas::MeshDecl           original;
+    std::vector<float>         positions;
+    std::vector<float>         normals;
+    std::vector<float>         uvs;
+    std::vector<std::uint32_t> indices;
+    std::vector<std::uint32_t> remap;
+};
+
+// Welds the vertices of a mesh in parallel. All vertices connected by pairs within the tolerances are welded
+// (transitively) to the lowest of them, so the result is deterministic. Out of range indices are kept out of range for xatlas to report.
+WeldedMesh weldMesh(xatlas::MeshDecl const& mesh, WeldOptions const& options, unsigned int threadCount = 0);
@@ -1,4 +1,9 @@
+import asyncio
+import concurrent.futures
+import json
 import os
+import pickle
+from concurrent.futures import ThreadPoolExecutor
 
 import numpy as np
 import pytest
@@ -76,6 +81,583 @@ def test_add_mesh():
     assert "out of range" in str(e.value)
 
 
+def test_add_mesh_dtypes():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    positions = np.ascontiguousarray(mesh.vertices, dtype=np.float32)
+    normals = np.ascontiguousarray(mesh.vertex_normals, dtype=np.float32)
+    indices = np.ascontiguousarray(mesh.faces, dtype=np.uint32)
+
+    # Interleaved vertex buffer
+    vertices = np.zeros((len(positions), 8), dtype=np.float32)
+    vertices[:, 0:3] = positions
+    vertices[:, 3:6] = normals
+
+    inputs = [
+        (positions, indices, None, False),
+        (positions, indices.astype(np.int32), None, False),
+        (positions, indices.astype(np.uint16), None, False),
+        (vertices[:, 0:3], indices, vertices[:, 3:6], False),
+        (mesh.vertices, mesh.faces, mesh.vertex_normals, True),  # float64 and int64
+        (positions[::-1], (len(positions) - 1 - indices), None, True),  # Negative strides
+        (positions.tolist(), indices.tolist(), None, True),
+    ]
+
+    charts = []
+    for positions_, indices_, normals_, copied in inputs:
+        atlas = xatlas.Atlas()
+        atlas.add_mesh(positions_, indices_, normals_)
+        assert atlas.last_input_copied == copied
+
+        atlas.generate()
+        charts.append(atlas.chart_count)
+
+    assert len(set(charts[:4])) == 1
+
+    # Indices outside of the uint32 range
+    atlas = xatlas.Atlas()
+    with pytest.raises(ValueError) as e:
+        atlas.add_mesh(positions, -mesh.faces)
+    assert "negative" in str(e.value)
+
+
+def test_memory_statistics():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    for pool_allocator in [False, True]:
+        atlas = xatlas.Atlas(pool_allocator=pool_allocator)
+        assert atlas.memory_budget is None
+
+        atlas.add_mesh(mesh.vertices, mesh.faces)
+        atlas.generate()
+
+        assert atlas.allocation_count > 0
+        assert atlas.peak_bytes >= atlas.current_bytes > 0
+        assert atlas.chart_count == 70
+
+    # Atlases generated concurrently account the allocations of their worker threads separately
+    atlases = [xatlas.Atlas() for _ in range(2)]
+    for atlas in atlases:
+        atlas.add_mesh(mesh.vertices, mesh.faces)
+    with ThreadPoolExecutor(max_workers=2) as executor:
+        list(executor.map(lambda atlas: atlas.generate(), atlases))
+    peaks = [atlas.peak_bytes for atlas in atlases]
+    assert min(peaks) > 0.5 * max(peaks)
+
+    # Exceeding the budget cancels the operation, also while other atlases exist
+    atlas = xatlas.Atlas(memory_budget=1 << 16)
+    assert atlas.memory_budget == 1 << 16
+    with pytest.raises(xatlas.MemoryBudgetError):
+        atlas.add_mesh(mesh.vertices, mesh.faces)
+        atlas.generate()
+    assert issubclass(xatlas.MemoryBudgetError, MemoryError)
+
+
+def test_stats(tmp_path):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate()
+    atlas.get_mesh(0)
+
+    stats = atlas.stats
+    for operation in ["add_mesh", "generate", "get_mesh"]:
+        assert stats["operations"][operation]["count"] == 1
+        assert stats["operations"][operation]["seconds"] >= 0
+    for stage in ["AddMesh", "ComputeCharts", "PackCharts", "BuildOutputMeshes"]:
+        assert stats["stages"][stage]["count"] >= 1
+    assert stats["counters"]["chart_count"] == 70
+    assert stats["counters"]["charts_per_mesh"] == [70]
+    assert stats["counters"]["face_count"] == 32668
+    assert stats["memory"]["peak_bytes"] > 0
+
+    path = tmp_path / "trace.json"
+    atlas.write_trace(str(path))
+    trace = json.loads(path.read_text())
+    names = {event["name"] for event in trace["traceEvents"] if event["ph"] == "X"}
+    assert {"generate", "ComputeCharts"} <= names
+
+
+@pytest.mark.parametrize("mmap", [True, False])
+def test_serialization(tmp_path, mmap):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    pack_options = xatlas.PackOptions()
+    pack_options.create_image = True
+    atlas.generate(pack_options=pack_options)
+
+    path = tmp_path / "atlas.bin"
+    atlas.save(str(path))
+
+    for restored in [xatlas.Atlas.load(str(path), mmap=mmap), pickle.loads(pickle.dumps(atlas))]:
+        assert restored.restored
+        assert restored.mesh_count == atlas.mesh_count
+        assert restored.chart_count == 70
+        assert (restored.width, restored.height) == (atlas.width, atlas.height)
+        assert restored.utilization == atlas.utilization
+
+        for expected, actual in zip(atlas.get_mesh(0), restored.get_mesh(0)):
+            assert np.array_equal(expected, actual)
+
+        expected, actual = atlas.get_charts(), restored.get_charts()
+        assert np.array_equal(expected.faces, actual.faces)
+        assert np.array_equal(expected.offsets, actual.offsets)
+        assert np.array_equal(atlas.chart_image, restored.chart_image)
+
+        with pytest.raises(RuntimeError) as e:
+            restored.add_mesh(mesh.vertices, mesh.faces)
+        assert "read-only" in str(e.value)
+
+    # Without the image
+    restored = xatlas.Atlas.from_bytes(atlas.to_bytes(include_image=False))
+    with pytest.raises(RuntimeError):
+        restored.chart_image
+
+    with pytest.raises(RuntimeError) as e:
+        xatlas.Atlas.from_bytes(atlas.to_bytes()[:-4])
+    assert "truncated" in str(e.value)
+
+
+def test_generate_cache(tmp_path):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+    cache = xatlas.Cache(str(tmp_path / "cache"))
+    pack_options = xatlas.PackOptions()
+    pack_options.create_image = True
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate(pack_options=pack_options, cache=cache)
+    assert (cache.hits, cache.misses) == (0, 1)
+
+    cached = xatlas.Atlas()
+    cached.add_mesh(mesh.vertices, mesh.faces)
+    cached.generate(pack_options=pack_options, cache=cache)
+    assert (cache.hits, cache.misses) == (1, 1)
+    assert "cache_load" in cached.stats["operations"]
+    assert not cached.restored
+
+    assert cached.chart_count == atlas.chart_count
+    for a, b in zip(atlas[0], cached[0]):
+        assert np.array_equal(a, b)
+    assert np.array_equal(atlas.chart_image, cached.chart_image)
+
+    # Other options miss the cache
+    pack_options.padding = 2
+    cached.generate(pack_options=pack_options, cache=cache)
+    assert (cache.hits, cache.misses) == (1, 2)
+
+    # Entries are evicted beyond the size limit
+    small = xatlas.Cache(str(tmp_path / "small"), max_bytes=1)
+    atlas.generate(cache=small)
+    assert small.size == 0
+
+
+def test_generate_async():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+
+    future = atlas.generate_async()
+    assert isinstance(future, concurrent.futures.Future)
+
+    # The atlas cannot be changed or read while the job is in flight
+    if not future.done():
+        with pytest.raises(RuntimeError) as e:
+            atlas.add_mesh(mesh.vertices, mesh.faces)
+        assert "in use" in str(e.value)
+    if not future.done():
+        with pytest.raises(RuntimeError) as e:
+            atlas.chart_count
+        assert "in use" in str(e.value)
+
+    assert future.result() is None
+    assert atlas.chart_count == 70
+
+    # Futures can be awaited and errors are propagated
+    async def generate():
+        atlas = xatlas.Atlas()
+        atlas.add_mesh(mesh.vertices, mesh.faces)
+        await atlas.generate_async(progress_callback=lambda *args: False)
+
+    with pytest.raises(xatlas.CancelledError):
+        asyncio.run(generate())
+
+
+def test_add_mesh_weld():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    # Triangle soup with three vertices per face
+    positions = mesh.vertices[mesh.faces].reshape(-1, 3)
+    faces = np.arange(positions.shape[0], dtype=np.uint32).reshape(-1, 3)
+
+    weld = xatlas.WeldOptions()
+    weld.epsilon = 1e-6
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(positions, faces, weld=weld)
+    atlas.generate()
+
+    # Welding restores the connectivity, so the soup is not split into a chart per face
+    assert atlas.chart_count < 1000
+
+    # The mapping refers to the vertices of the soup
+    vmapping, indices, uvs = atlas[0]
+    assert vmapping.max() < positions.shape[0]
+    assert np.allclose(positions[vmapping[indices]], mesh.vertices[mesh.faces])
+
+    # Also after serialization
+    restored = pickle.loads(pickle.dumps(atlas))
+    assert np.array_equal(restored[0][0], vmapping)
+
+    vmapping, indices, _ = xatlas.parametrize(positions, faces, weld=weld)
+    assert np.allclose(positions[vmapping[indices]], mesh.vertices[mesh.faces])
+
+    # Chains of vertices within the tolerance are welded, even if their ends are farther apart
+    weld.epsilon = 1e-3
+    center = [[0, 0, 0], [1.9e-3, 0, 0], [0.95e-3, 0, 0]]
+    rim = [[1, 0, 0], [0, 1, 0], [-1, 0, 0], [0, -1, 0]]
+    positions = np.array([center[0], rim[0], rim[1], center[1], rim[1], rim[2], center[2], rim[2], rim[3]])
+    faces = np.arange(9, dtype=np.uint32).reshape(-1, 3)
+    vmapping, indices, _ = xatlas.parametrize(positions, faces, weld=weld)
+    assert np.all(vmapping[indices[:, 0]] == 0)
+
+
+def test_bake_geometry():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    pack_options = xatlas.PackOptions()
+    pack_options.resolution = 256
+    pack_options.padding = 2
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate(pack_options=pack_options)
+
+    baked = atlas.bake_geometry([mesh.vertices], [mesh.vertex_normals])
+    shape = (atlas.atlas_count, atlas.height, atlas.width)
+    assert baked["mesh_index"].shape == shape
+    assert baked["triangle_index"].shape == shape
+    assert baked["barycentrics"].shape == shape + (3,)
+    assert baked["position"].shape == shape + (3,)
+    assert baked["normal"].shape == shape + (3,)
+
+    covered = baked["triangle_index"] >= 0
+    assert covered.any() and not covered.all()
+    assert np.all(baked["mesh_index"][covered] == 0)
+    assert baked["triangle_index"].max() < mesh.faces.shape[0]
+    assert np.allclose(baked["barycentrics"][covered].sum(axis=-1), 1, atol=1e-4)
+    assert np.all(baked["position"][covered] >= mesh.vertices.min(axis=0) - 1e-4)
+    assert np.all(baked["position"][covered] <= mesh.vertices.max(axis=0) + 1e-4)
+    assert np.allclose(np.linalg.norm(baked["normal"][covered], axis=-1), 1, atol=1e-3)
+    assert np.all(baked["barycentrics"][~covered] == 0)
+
+    # Conservative rasterization additionally covers the texels at the chart borders
+    exact = atlas.bake_geometry(conservative=False)
+    assert "position" not in exact
+    assert np.count_nonzero(exact["triangle_index"] >= 0) < np.count_nonzero(covered)
+
+    with pytest.raises(ValueError):
+        atlas.bake_geometry([mesh.vertices, mesh.vertices])
+
+
+def test_remap_texture():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    # Textured mesh: the output of a first parametrization
+    vmapping, indices, uvs = xatlas.parametrize(mesh.vertices, mesh.faces)
+    positions = mesh.vertices[vmapping]
+
+    pack_options = xatlas.PackOptions()
+    pack_options.resolution = 256
+    pack_options.padding = 2
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(positions, indices)
+    atlas.generate(pack_options=pack_options)
+
+    # The horizontal gradient is reproduced exactly by bilinear sampling
+    texture = np.tile((np.arange(512, dtype=np.float32) + 0.5) / 512, (128, 1))
+    remapped = atlas.remap_texture(texture, [uvs], dilation=0)
+    assert remapped.dtype == np.float32
+    assert remapped.shape == (atlas.atlas_count, atlas.height, atlas.width)
+
+    baked = atlas.bake_geometry()
+    covered = baked["triangle_index"] >= 0
+    new_vmapping, new_indices, _ = atlas[0]
+    corners = new_vmapping[new_indices[baked["triangle_index"][covered]]]
+    expected = np.einsum("nk,nk->n", baked["barycentrics"][covered], uvs[corners, 0])
+    assert np.allclose(remapped[covered], np.clip(expected, 0.5 / 512, 1 - 0.5 / 512), atol=1e-3)
+    assert np.all(remapped[~covered] == 0)
+
+    # uint8 textures with channels, dilated into the padding
+    color = np.full((64, 64, 3), (10, 20, 30), dtype=np.uint8)
+    remapped = atlas.remap_texture([color], [uvs])
+    assert remapped.dtype == np.uint8
+    assert remapped.shape == (atlas.atlas_count, atlas.height, atlas.width, 3)
+    filled = remapped.any(axis=-1)
+    assert np.count_nonzero(filled) > np.count_nonzero(covered)
+    assert np.all(remapped[filled] == (10, 20, 30))
+
+    with pytest.raises(ValueError):
+        atlas.remap_texture([color, color], [uvs])
+
+
+def test_chart_id_image():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    pack_options = xatlas.PackOptions()
+    pack_options.create_image = True
+    pack_options.resolution = 256
+    atlas.generate(pack_options=pack_options)
+
+    images = atlas.get_chart_image()
+    assert images.shape == (atlas.atlas_count, atlas.height, atlas.width, 3)
+    assert np.array_equal(images[0], atlas.chart_image)
+
+    ids = atlas.chart_id_image
+    assert ids.dtype == np.uint32
+    assert ids.shape == (atlas.atlas_count, atlas.height, atlas.width)
+    assert not ids.flags.writeable
+    assert np.all(images[ids == 0] == 0)
+    assert np.any(ids != 0)
+
+    # The view references the image, so the atlas cannot be regenerated meanwhile
+    with pytest.raises(RuntimeError):
+        atlas.generate(pack_options=pack_options)
+
+    del ids
+    atlas.generate(pack_options=pack_options)
+
+
+def test_add_meshes(tmp_path):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+    cache = xatlas.Cache(str(tmp_path / "cache"))
+
+    # Two instances in concatenated arrays, with indices relative to each instance
+    positions = np.concatenate([mesh.vertices, mesh.vertices + 1.0])
+    faces = np.concatenate([mesh.faces, mesh.faces])
+    vertex_offsets = [0, len(mesh.vertices), 2 * len(mesh.vertices)]
+    face_offsets = [0, len(mesh.faces), 2 * len(mesh.faces)]
+
+    separate = xatlas.Atlas()
+    separate.add_mesh(positions[: len(mesh.vertices)], mesh.faces)
+    separate.add_mesh(positions[len(mesh.vertices) :], mesh.faces)
+    separate.generate(cache=cache)
+
+    # Batches hash like separate meshes, so they share cache entries
+    batched = xatlas.Atlas()
+    batched.add_meshes(positions, faces, vertex_offsets, face_offsets)
+    batched.generate(cache=cache)
+    assert (cache.hits, cache.misses) == (1, 1)
+    assert batched.mesh_count == 2
+    for i in range(2):
+        for a, b in zip(separate[i], batched[i]):
+            assert np.array_equal(a, b)
+
+    # UV meshes
+    vmapping, indices, uvs = xatlas.parametrize(mesh.vertices, mesh.faces)
+    atlas = xatlas.Atlas()
+    atlas.add_uv_meshes(
+        np.concatenate([uvs, uvs]),
+        np.concatenate([indices, indices]),
+        [0, len(uvs), 2 * len(uvs)],
+        [0, len(indices), 2 * len(indices)],
+        face_materials=np.repeat(np.arange(2, dtype=np.uint32), len(indices)),
+    )
+    atlas.generate()
+    assert atlas.mesh_count == 2
+
+    with pytest.raises(ValueError):
+        xatlas.Atlas().add_meshes(positions, faces, vertex_offsets, [0, len(mesh.faces)])
+    with pytest.raises(ValueError):
+        xatlas.Atlas().add_meshes(positions, faces, [0, len(positions) + 1], [0, len(faces)])
+
+    # Errors name the failing mesh
+    invalid = faces.copy()
+    invalid[-1, 0] = len(mesh.vertices)
+    atlas = xatlas.Atlas()
+    with pytest.raises(RuntimeError) as e:
+        atlas.add_meshes(positions, invalid, vertex_offsets, face_offsets)
+    assert "mesh 1" in str(e.value)
+
+
+def test_pack_incremental():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate()
+    size = np.array([atlas.width, atlas.height])
+    _, _, uvs = atlas[0]
+
+    # The added meshes are generated separately with the same scale
+    pack_options = xatlas.PackOptions()
+    pack_options.texels_per_unit = atlas.texels_per_unit
+    added = xatlas.Atlas()
+    added.add_mesh(mesh.vertices * 0.5, mesh.faces)
+    added.generate(pack_options=pack_options)
+
+    chart_count = atlas.chart_count + added.chart_count
+    atlas.pack_incremental(added, grow=True)
+    assert atlas.mesh_count == 2
+    assert atlas.chart_count == chart_count
+    assert atlas.width >= size[0] and atlas.height >= size[1]
+    assert 0 < atlas.utilization <= 1
+
+    # Existing charts keep their texel positions
+    assert np.allclose(atlas[0][2] * [atlas.width, atlas.height], uvs * size)
+    for a, b in zip(added[0][:2], atlas[1][:2]):
+        assert np.array_equal(a, b)
+
+    # Added triangles do not overlap the existing charts
+    baked = atlas.bake_geometry(conservative=False)
+    _, indices, new_uvs = atlas[1]
+    centers = new_uvs[indices].mean(axis=1) * [atlas.width, atlas.height]
+    atlas_index = atlas.get_mesh_vertex_assignment(1)[0][indices[:, 0]]
+    covering = baked["mesh_index"][atlas_index, centers[:, 1].astype(int), centers[:, 0].astype(int)]
+    assert np.all(covering != 0)
+
+    # The composed atlas can only be extended incrementally
+    with pytest.raises(RuntimeError):
+        atlas.generate()
+
+    # Charts of other scales do not fit in
+    other = xatlas.Atlas()
+    other.add_mesh(mesh.vertices * 2, mesh.faces)
+    other.generate()
+    with pytest.raises(ValueError):
+        atlas.pack_incremental(other)
+
+
+def _occupied_blocks(atlas, padding, block_size=4):
+    # Blocks overlapped by the padded bounds of every triangle, as marked by pack_incremental
+    fmt = xatlas.OutputFormat()
+    fmt.normalized = False
+    columns, rows = atlas.width // block_size, atlas.height // block_size
+    occupied = np.zeros((atlas.atlas_count, rows, columns), dtype=bool)
+    for m in range(atlas.mesh_count):
+        _, indices, texels = atlas.get_mesh(m, format=fmt)
+        atlas_index = atlas.get_mesh_vertex_assignment(m)[0][indices[:, 0]]
+        corners = texels[indices]
+        low = corners.min(axis=1) - np.float32(padding)
+        high = corners.max(axis=1) + np.float32(padding)
+        inside = (
+            (atlas_index < atlas.atlas_count)
+            & np.all(high >= 0, axis=1)
+            & (low[:, 0] < columns * block_size)
+            & (low[:, 1] < rows * block_size)
+        )
+        start = np.maximum(low[inside], 0).astype(np.uint32) // block_size
+        end = np.minimum(high[inside].astype(np.uint32) // block_size, [columns - 1, rows - 1])
+        for a, (x0, y0), (x1, y1) in zip(atlas_index[inside], start, end):
+            occupied[a, y0 : y1 + 1, x0 : x1 + 1] = True
+    return occupied
+
+
+def _first_fit(occupied, width, height):
+    # Tries every position of every sub-atlas, top to bottom and left to right
+    for a in range(len(occupied)):
+        rows, columns = occupied[a].shape
+        if width > columns or height > rows:
+            continue
+        table = np.zeros((rows + 1, columns + 1), dtype=np.int64)
+        table[1:, 1:] = occupied[a].cumsum(axis=0).cumsum(axis=1)
+        used = table[height:, width:] - table[:-height, width:] - table[height:, :-width] + table[:-height, :-width]
+        free = np.argwhere(used == 0)
+        if len(free) > 0:
+            return a, free[0][1], free[0][0]
+    return None
+
+
+def test_pack_incremental_first_fit():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+    rng = np.random.default_rng(0)
+    block_size = 4
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate()
+
+    fmt = xatlas.OutputFormat()
+    fmt.normalized = False
+    pack_options = xatlas.PackOptions()
+    pack_options.texels_per_unit = atlas.texels_per_unit
+
+    # Random meshes are placed where an exhaustive search over the blocks finds the first free rectangle
+    for _ in range(6):
+        padding = int(rng.integers(0, 3))
+        begin = int(rng.integers(0, len(mesh.faces) // 2))
+        end = int(rng.integers(begin + 1, len(mesh.faces) + 1))
+        added = xatlas.Atlas()
+        added.add_mesh(mesh.vertices * rng.uniform(0.2, 0.8), mesh.faces[begin:end])
+        added.generate(pack_options=pack_options)
+
+        occupied = list(_occupied_blocks(atlas, padding, block_size))
+        _, indices, texels = added.get_mesh(0, format=fmt)
+        charts = added.get_charts(0)
+
+        # Large charts are placed first, charts without faces are skipped
+        bounds = {}
+        for c in range(len(charts.offsets) - 1):
+            faces = charts.faces[charts.offsets[c] : charts.offsets[c + 1]]
+            if len(faces) > 0:
+                corners = texels[indices[faces]].reshape(-1, 2)
+                bounds[c] = (corners.min(axis=0), corners.max(axis=0))
+        order = sorted(bounds, key=lambda c: -float(bounds[c][1][0] - bounds[c][0][0]) * float(bounds[c][1][1] - bounds[c][0][1]))
+
+        expected = {}
+        for c in order:
+            low, high = bounds[c]
+            origin = np.floor(low)
+            size = (np.ceil(high) - origin).astype(np.uint32) + 1 + 2 * padding
+            width, height = (size + block_size - 1) // block_size
+
+            fit = _first_fit(occupied, width, height)
+            if fit is None:
+                # Spills into a new sub-atlas
+                occupied.append(np.zeros_like(occupied[0]))
+                fit = _first_fit(occupied[-1:], width, height)
+                fit = (len(occupied) - 1, fit[1], fit[2])
+            a, x, y = fit
+            occupied[a][y : y + height, x : x + width] = True
+            expected[c] = (a, int(x * block_size + padding - origin[0]), int(y * block_size + padding - origin[1]))
+
+        atlas.pack_incremental(added, padding=padding, grow=False, spill=True, num_threads=int(rng.integers(1, 5)))
+        assert atlas.atlas_count == len(occupied)
+
+        _, _, placed = atlas.get_mesh(atlas.mesh_count - 1, format=fmt)
+        atlas_index = atlas.get_mesh_vertex_assignment(atlas.mesh_count - 1)[0]
+        for c, (a, dx, dy) in expected.items():
+            vertices = np.unique(indices[charts.faces[charts.offsets[c] : charts.offsets[c + 1]]])
+            assert np.all(atlas_index[vertices] == a)
+            assert np.array_equal(placed[vertices], texels[vertices] + np.array([dx, dy], dtype=np.float32))
+
+
+def test_add_mesh_from_file():
+    atlas = xatlas.Atlas()
+
+    with pytest.raises(ValueError) as e:
+        atlas.add_mesh_from_file(os.path.join(cwd, "data", "missing.obj"))
+    assert "Cannot open" in str(e.value)
+
+    with pytest.raises(ValueError) as e:
+        atlas.add_mesh_from_file(os.path.join(cwd, "data", "00190663.stl"))
+    assert "Unsupported" in str(e.value)
+
+    atlas.add_mesh_from_file(os.path.join(cwd, "data", "00190663.obj"))
+    atlas.generate()
+
+    assert atlas.mesh_count == 1
+    _, indices, _ = atlas.get_mesh(0)
+    assert indices.shape == (32668, 3)
+
+
 def test_generate():
     mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
 
@@ -121,3 +703,232 @@ def test_get_mesh():
     with pytest.raises(IndexError) as e:
         atlas.get_mesh(1)
     assert "out of bounds" in str(e.value)
+
+
+def test_get_mesh_format():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate()
+
+    vmapping, indices, uvs = atlas.get_mesh(0)
+
+    # Compact encodings
+    fmt = xatlas.OutputFormat()
+    fmt.index_type = "auto"
+    fmt.uv_type = "float16"
+    vmapping16, indices16, uvs16 = atlas.get_mesh(0, format=fmt)
+    assert indices16.dtype == np.uint16 and uvs16.dtype == np.float16
+    assert np.array_equal(vmapping16, vmapping)
+    assert np.array_equal(indices16, indices)
+    assert np.array_equal(uvs16, uvs.astype(np.float16))
+
+    fmt.index_type = "uint16"
+    fmt.uv_type = "unorm16"
+    _, indices16, uvs16 = atlas.get_mesh(0, format=fmt)
+    assert indices16.dtype == np.uint16 and uvs16.dtype == np.uint16
+    assert np.abs(uvs16 / 65535.0 - uvs).max() <= 0.5 / 65535 + 1e-6
+
+    # Texture coordinates in texels
+    fmt = xatlas.OutputFormat()
+    fmt.normalized = False
+    _, _, texels = atlas.get_mesh(0, format=fmt)
+    assert np.allclose(texels, uvs * [atlas.width, atlas.height], atol=1e-3)
+
+    # Interleaved vertex buffer
+    fmt.interleaved = True
+    fmt.normalized = True
+    vertices, indices32 = atlas.get_mesh(0, format=fmt)
+    assert vertices.dtype.names == ("uv", "mapping") and vertices.dtype.itemsize == 12
+    assert np.array_equal(vertices["mapping"], vmapping)
+    assert np.array_equal(vertices["uv"], uvs)
+    assert np.array_equal(indices32, indices)
+
+    # Invalid formats
+    fmt = xatlas.OutputFormat()
+    fmt.uv_type = "float64"
+    with pytest.raises(ValueError) as e:
+        atlas.get_mesh(0, format=fmt)
+    assert "Unknown UV type" in str(e.value)
+
+    fmt.uv_type = "unorm16"
+    fmt.normalized = False
+    with pytest.raises(ValueError) as e:
+        atlas.get_mesh(0, format=fmt)
+    assert "must be normalized" in str(e.value)
+
+
+def test_get_meshes():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    weld = xatlas.WeldOptions()
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.add_mesh(mesh.vertices[mesh.faces].reshape(-1, 3), np.arange(3 * len(mesh.faces)).reshape(-1, 3), weld=weld)
+    atlas.generate()
+
+    meshes = atlas.get_meshes()
+    assert len(meshes) == 2
+    assert meshes.vertex_offsets[0] == 0 and meshes.vertex_offsets[-1] == len(meshes.mapping)
+    assert meshes.face_offsets[0] == 0 and meshes.face_offsets[-1] == len(meshes.indices)
+    assert meshes.uvs.shape == (len(meshes.mapping), 2)
+
+    for i in range(2):
+        vertices = slice(meshes.vertex_offsets[i], meshes.vertex_offsets[i + 1])
+        faces = slice(meshes.face_offsets[i], meshes.face_offsets[i + 1])
+        vmapping, indices, uvs = atlas[i]
+        assert np.array_equal(meshes.mapping[vertices], vmapping)
+        assert np.array_equal(meshes.indices[faces], indices)
+        assert np.array_equal(meshes.uvs[vertices], uvs)
+
+
+def test_generate_threads():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    def generate(_):
+        atlas = xatlas.Atlas()
+        atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+        atlas.generate()
+        return atlas.get_mesh(0)
+
+    # Atlases generated concurrently (with the GIL released) yield the same result
+    with ThreadPoolExecutor(max_workers=2) as executor:
+        results = list(executor.map(generate, range(2)))
+
+    for a, b in zip(results[0], results[1]):
+        assert np.array_equal(a, b)
+
+    # One atlas can be read by several threads at once
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate()
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        meshes = list(executor.map(lambda _: atlas.get_mesh(0), range(16)))
+    for vmapping, indices, uvs in meshes:
+        assert np.array_equal(vmapping, meshes[0][0])
+        assert np.array_equal(uvs, meshes[0][2])
+
+
+def test_compute_and_pack_charts():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+
+    # Packing requires computed charts
+    with pytest.raises(RuntimeError) as e:
+        atlas.pack_charts()
+    assert "compute_charts" in str(e.value)
+
+    atlas.compute_charts()
+
+    # The same charts can be packed multiple times with different options
+    for resolution in [512, 1024]:
+        pack_options = xatlas.PackOptions()
+        pack_options.resolution = resolution
+        atlas.pack_charts(pack_options)
+
+        assert atlas.chart_count == 70
+        assert atlas.width <= resolution
+        assert atlas.height <= resolution
+
+        vmapping, indices, uvs = atlas.get_mesh(0)
+        assert indices.shape == (32668, 3)
+
+
+def test_time_budget():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    # Without budget, only the fast tier runs
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    atlas.generate(time_budget=0)
+    packing = atlas.stats["packing"]
+    assert packing["tier"] == "fast"
+    assert packing["tiers_completed"] == 1
+    assert packing["deadline_reached"]
+    assert packing["utilization"] == [atlas.utilization]
+    fast = atlas.width * atlas.height * atlas.atlas_count
+
+    # With enough time, all tiers run and the best packing is kept
+    atlas.generate(time_budget=600)
+    packing = atlas.stats["packing"]
+    assert packing["tiers_completed"] == 3
+    assert not packing["deadline_reached"]
+    assert packing["tier"] in ("fast", "brute_force_block_aligned", "brute_force")
+    assert atlas.width * atlas.height * atlas.atlas_count <= fast
+    assert atlas.chart_count == 70
+    assert atlas[0][1].shape == (32668, 3)
+
+    # The charts can be repacked with a budget
+    atlas.pack_charts(time_budget=0)
+    assert atlas.stats["packing"]["tiers_completed"] == 1
+
+    with pytest.raises(ValueError):
+        atlas.generate(time_budget=-1)
+
+
+def test_progress_callback():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+
+    stages = set()
+
+    def callback(category, progress):
+        assert 0 <= progress <= 100
+        stages.add(category)
+
+    atlas.generate(progress_callback=callback)
+    assert xatlas.ProgressCategory.ComputeCharts in stages
+    assert xatlas.ProgressCategory.PackCharts in stages
+
+    # Returning False cancels the operation
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+    with pytest.raises(xatlas.CancelledError):
+        atlas.generate(progress_callback=lambda category, progress: False)
+
+    # Exceptions raised by the callback are propagated
+    def failing_callback(category, progress):
+        raise ValueError("Callback failed")
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+    with pytest.raises(ValueError) as e:
+        atlas.generate(progress_callback=failing_callback)
+    assert "Callback failed" in str(e.value)
+
+
+def test_get_charts():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+    atlas.add_mesh(mesh.vertices, mesh.faces, mesh.vertex_normals)
+    atlas.generate()
+
+    # All charts of the atlas
+    charts = atlas.get_charts()
+    assert len(charts) == atlas.chart_count
+    assert charts.offsets.shape == (atlas.chart_count + 1,)
+    assert charts.offsets[-1] == charts.faces.shape[0] == 2 * 32668
+    assert np.all(np.diff(charts.offsets) > 0)
+
+    # Charts of one mesh agree with the per-chart accessor
+    charts = atlas.get_charts(1)
+    assert len(charts) == atlas.get_mesh_chart_count(1)
+    assert np.all(charts.mesh_index == 1)
+    for i in range(len(charts)):
+        chart = atlas.get_mesh_chart(1, i)
+        faces = charts.faces[charts.offsets[i] : charts.offsets[i + 1]]
+        assert np.array_equal(faces, chart.faces)
+        assert charts.atlas_index[i] == chart.atlas_index
+        assert charts.type[i] == int(chart.type)
+        assert charts.material[i] == chart.material
+
+    with pytest.raises(IndexError) as e:
+        atlas.get_charts(2)
+    assert "out of bounds" in str(e.value)
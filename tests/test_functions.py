@@ -1,4 +1,7 @@
+import asyncio
 import os
+import numpy as np
+import pytest
 import trimesh
 import xatlas
 
@@ -15,3 +18,189 @@ def test_parametrize():
     assert vmapping.shape == (18996,)
     assert indices.shape == (32668, 3)
     assert uvs.shape == (18996, 2)
+
+    # Outputs that can be uploaded to the GPU as is
+    fmt = xatlas.OutputFormat()
+    fmt.index_type = "auto"
+    fmt.uv_type = "unorm16"
+    fmt.interleaved = True
+    vertices, indices16 = xatlas.parametrize(
+        mesh.vertices, mesh.faces, mesh.vertex_normals, format=fmt
+    )
+    assert vertices.shape == (18996,) and vertices.dtype.itemsize == 8
+    assert np.array_equal(vertices["mapping"], vmapping)
+    assert indices16.dtype == np.uint16
+    assert np.array_equal(indices16, indices)
+
+
+def test_parametrize_cache(tmp_path):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+    cache = xatlas.Cache(str(tmp_path / "cache"), max_bytes=64 * 1024**2)
+
+    expected = xatlas.parametrize(mesh.vertices, mesh.faces, cache=cache)
+    assert (cache.hits, cache.misses) == (0, 1)
+    assert cache.size > 0
+
+    # The same values in other dtypes hit the cache
+    result = xatlas.parametrize(mesh.vertices.astype(np.float32), mesh.faces.astype(np.uint32), cache=cache)
+    assert (cache.hits, cache.misses) == (1, 1)
+    for a, b in zip(expected, result):
+        assert np.array_equal(a, b)
+
+    # Different inputs do not
+    xatlas.parametrize(mesh.vertices, mesh.faces, mesh.vertex_normals, cache=cache)
+    assert (cache.hits, cache.misses) == (1, 2)
+
+    cache.clear()
+    assert cache.size == 0
+
+
+def test_parametrize_async():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    async def parametrize():
+        return await asyncio.gather(
+            xatlas.parametrize_async(mesh.vertices, mesh.faces),
+            xatlas.parametrize_async(mesh.vertices, mesh.faces, mesh.vertex_normals),
+        )
+
+    for vmapping, indices, uvs in asyncio.run(parametrize()):
+        assert indices.shape == (32668, 3)
+        assert vmapping.shape[0] == uvs.shape[0]
+
+    with pytest.raises(RuntimeError):
+        xatlas.parametrize_async(np.random.rand(1, 3), mesh.faces).result()
+
+    # Triangle soups are welded like in parametrize
+    positions = mesh.vertices[mesh.faces].reshape(-1, 3)
+    faces = np.arange(positions.shape[0]).reshape(-1, 3)
+    vmapping, indices, _ = xatlas.parametrize_async(positions, faces, weld=xatlas.WeldOptions()).result()
+    assert np.allclose(positions[vmapping[indices]], mesh.vertices[mesh.faces])
+    assert vmapping.shape[0] < positions.shape[0]
+
+
+def test_parametrize_batch():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    meshes = [
+        (mesh.vertices, mesh.faces),
+        (mesh.vertices, mesh.faces, mesh.vertex_normals),
+        (np.random.rand(1, 3), mesh.faces),  # Invalid mesh
+    ]
+
+    results, errors = xatlas.parametrize_batch(meshes, num_threads=2)
+    assert len(results) == len(errors) == 3
+
+    # Results are in input order
+    for result, error in zip(results[:2], errors[:2]):
+        assert error is None
+        vmapping, indices, uvs = result
+        assert indices.shape == (32668, 3)
+        assert vmapping.shape[0] == uvs.shape[0]
+
+    # Failures do not abort the batch
+    assert results[2] is None
+    assert "out of range" in errors[2]
+
+    # Triangle soups are welded per mesh
+    positions = mesh.vertices[mesh.faces].reshape(-1, 3)
+    faces = np.arange(positions.shape[0]).reshape(-1, 3)
+    results, errors = xatlas.parametrize_batch([(positions, faces)], weld=xatlas.WeldOptions())
+    vmapping, indices, _ = results[0]
+    assert np.allclose(positions[vmapping[indices]], mesh.vertices[mesh.faces])
+    assert vmapping.shape[0] < positions.shape[0]
+
+
+def test_thread_count():
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+    default = xatlas.get_thread_count()
+    assert default >= 1
+
+    try:
+        for thread_count in [1, 3]:
+            xatlas.set_thread_count(thread_count)
+            assert xatlas.get_thread_count() == thread_count
+
+            results, errors = xatlas.parametrize_batch([(mesh.vertices, mesh.faces)] * 4)
+            assert errors == [None] * 4
+            assert all(result[1].shape == (32668, 3) for result in results)
+
+            # The task scheduler of xatlas is capped as well, without changing the result
+            atlas = xatlas.Atlas()
+            atlas.add_mesh(mesh.vertices, mesh.faces)
+            atlas.generate()
+            assert atlas.chart_count == 70
+    finally:
+        xatlas.set_thread_count(0)
+
+    atlas = xatlas.Atlas()
+    atlas.add_mesh(mesh.vertices, mesh.faces)
+    for num_threads in [1, 2, 0]:
+        atlas.generate(num_threads=num_threads)
+        assert atlas.chart_count == 70
+    atlas.generate_async(num_threads=1).result()
+    assert atlas.chart_count == 70
+
+    assert xatlas.get_thread_count() == default
+    assert isinstance(xatlas.multithreaded, bool)
+
+
+def test_export(tmp_path):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    vmapping, indices, uvs = xatlas.parametrize(mesh.vertices, mesh.faces)
+    positions = mesh.vertices[vmapping].astype(np.float32)
+
+    # The output matches the `%g` formatting of the previous stream based writer,
+    # regardless of the number of threads used for formatting
+    expected = (
+        ["v " + " ".join("%g" % c for c in p) for p in positions.tolist()]
+        + ["vt " + " ".join("%g" % c for c in uv) for uv in uvs.tolist()]
+        + ["f " + " ".join(f"{i + 1}/{i + 1}" for i in f) for f in indices.tolist()]
+    )
+
+    for num_threads in [1, 4]:
+        path = tmp_path / f"output_{num_threads}.obj"
+        xatlas.export(str(path), positions, indices, uvs, num_threads=num_threads)
+        assert path.read_text().splitlines() == expected
+
+
+def test_load(tmp_path):
+    mesh = trimesh.load_mesh(os.path.join(cwd, "data", "00190663.obj"))
+
+    vmapping, indices, uvs = xatlas.parametrize(mesh.vertices, mesh.faces)
+    positions = mesh.vertices[vmapping].astype(np.float32)
+    normals = mesh.vertex_normals[vmapping].astype(np.float32)
+
+    path = tmp_path / "output.obj"
+    xatlas.export(str(path), positions, indices, uvs, normals)
+
+    for num_threads in [1, 4]:
+        loaded_positions, loaded_indices, loaded_normals, loaded_uvs = xatlas.load_obj(str(path), num_threads=num_threads)
+        np.testing.assert_allclose(loaded_positions, positions, rtol=1e-5, atol=1e-6)
+        np.testing.assert_array_equal(loaded_indices, indices)
+        np.testing.assert_allclose(loaded_normals, normals, rtol=1e-5, atol=1e-6)
+        np.testing.assert_allclose(loaded_uvs, uvs, rtol=1e-5, atol=1e-6)
+
+    path = tmp_path / "output.ply"
+    trimesh.Trimesh(positions, indices, process=False).export(str(path))
+    loaded_positions, loaded_indices, loaded_normals, loaded_uvs = xatlas.load_ply(str(path))
+    np.testing.assert_allclose(loaded_positions, positions)
+    np.testing.assert_array_equal(loaded_indices, indices)
+
+    # Trailing comments and empty attributes as written by some exporters
+    path = tmp_path / "comments.obj"
+    path.write_text("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3 # triangle\nf 1/ 2/ 3/\n")
+    _, loaded_indices, _, _ = xatlas.load_obj(str(path))
+    np.testing.assert_array_equal(loaded_indices, [[0, 1, 2], [0, 1, 2]])
+
+    # Faces before vertices
+    path = tmp_path / "faces_first.ply"
+    path.write_text(
+        "ply\nformat ascii 1.0\nelement face 1\nproperty list uchar int vertex_indices\n"
+        "element vertex 3\nproperty float x\nproperty float y\nproperty float z\nend_header\n"
+        "3 0 1 2\n0 0 0\n1 0 0\n1 1 0\n"
+    )
+    loaded_positions, loaded_indices, _, _ = xatlas.load_ply(str(path))
+    assert loaded_positions.shape == (3, 3)
+    np.testing.assert_array_equal(loaded_indices, [[0, 1, 2]])